@@ -0,0 +1,335 @@
+#include "compiler/baseline_compiler.hpp"
+#include "bitops.h"
+#include "generated/instructions_enum_gen.h"
+#include "interpreter/executor.h"
+
+namespace simulator::compiler {
+
+namespace x86 = asmjit::x86;
+
+// Fixed host registers of the generated code, all callee-saved so they survive interpreter calls
+static const x86::Gp REGISTERS_P = x86::rbx;
+static const x86::Gp EXECUTOR_P = x86::r12;
+static const x86::Gp INSTRUCTION_P = x86::r13;
+
+static x86::Mem GuestReg(size_t index)
+{
+    return x86::qword_ptr(REGISTERS_P, index * sizeof(Register));
+}
+
+static x86::Mem GuestReg32(size_t index)
+{
+    return x86::dword_ptr(REGISTERS_P, index * sizeof(Register));
+}
+
+void BaselineCompiler::run(interpreter::CompiledRegion &region, size_t *hotness, size_t optimize_threshold,
+                           bool is_cosim)
+{
+    asmjit::CodeHolder code_holder;
+    code_holder.init(runtime_.environment(), runtime_.cpuFeatures());
+    x86::Assembler as(&code_holder);
+    region_ = &region;
+
+    // Three pushes keep the stack aligned for calls
+    as.push(REGISTERS_P);
+    as.push(EXECUTOR_P);
+    as.push(INSTRUCTION_P);
+    as.mov(EXECUTOR_P, x86::rdi);
+    as.mov(INSTRUCTION_P, x86::rsi);
+    as.lea(REGISTERS_P, x86::qword_ptr(x86::rdi, interpreter::Executor::getOffsetToGprf()));
+
+    auto body = as.newLabel();
+    as.mov(x86::rax, reinterpret_cast<uint64_t>(hotness));
+    as.inc(x86::qword_ptr(x86::rax));
+    as.mov(x86::rcx, optimize_threshold);
+    as.cmp(x86::qword_ptr(x86::rax), x86::rcx);
+    as.jne(body);
+    as.xor_(x86::eax, x86::eax);
+    emitReturn(as);
+    as.bind(body);
+
+    const auto &trace = region.trace;
+    for (size_t i = 0; i < trace.instrs.size(); ++i) {
+        instr_pc_ = trace.pcs[i];
+        retired_ = i + 1;
+        if (is_cosim || !emitInstr(as, &trace.instrs[i])) {
+            emitSetPC(as, instr_pc_);
+            emitInvoke(as, i);
+        }
+    }
+
+    // Branches and JAL emit their own exits, JALR and interpreted terminators have set the PC already.
+    // FENCE.I returns to the dispatcher, so stale translations are dropped before the next block
+    auto last_id = trace.instrs.empty() ? InstructionId::BB_END_INST : trace.instrs.back().inst_id;
+    retired_ = trace.instrs.size();
+    if (is_cosim || last_id == InstructionId::JALR || last_id == InstructionId::FENCE_I) {
+        emitRetire(as);
+        as.xor_(x86::eax, x86::eax);
+        emitReturn(as);
+    } else if (last_id != InstructionId::JAL && last_id != InstructionId::BEQ && last_id != InstructionId::BNE &&
+               last_id != InstructionId::BLT && last_id != InstructionId::BGE && last_id != InstructionId::BLTU &&
+               last_id != InstructionId::BGEU) {
+        emitSetPC(as, instr_pc_ + sizeof(uint32_t));
+        emitChainExit(as, instr_pc_ + sizeof(uint32_t));
+    }
+
+    region.code_size = code_holder.codeSize();
+    runtime_.add(&region.entry, &code_holder);
+}
+
+void BaselineCompiler::emitReturn(x86::Assembler &as)
+{
+    as.pop(INSTRUCTION_P);
+    as.pop(EXECUTOR_P);
+    as.pop(REGISTERS_P);
+    as.ret();
+}
+
+void BaselineCompiler::emitSetPC(x86::Assembler &as, Register pc)
+{
+    as.mov(x86::rax, pc);
+    as.mov(GuestReg(GPR_file::PC), x86::rax);
+}
+
+void BaselineCompiler::emitInvoke(x86::Assembler &as, size_t instr_offset)
+{
+    region_->fallbacks.push_back(region_->trace.instrs[instr_offset].inst_id);
+    as.mov(x86::rdi, EXECUTOR_P);
+    as.lea(x86::rsi, x86::qword_ptr(INSTRUCTION_P, instr_offset * sizeof(Instruction)));
+    as.mov(x86::rax, reinterpret_cast<uint64_t>(&interpreter::runInstrIface));
+    as.call(x86::rax);
+}
+
+void BaselineCompiler::emitRetire(x86::Assembler &as)
+{
+    as.add(x86::qword_ptr(EXECUTOR_P, interpreter::Executor::getOffsetToCompiledInstrs()), retired_);
+}
+
+void BaselineCompiler::emitChainExit(x86::Assembler &as, Register target_pc)
+{
+    auto *slot = region_->addSuccessor(target_pc);
+    emitRetire(as);
+    as.mov(x86::rax, reinterpret_cast<uint64_t>(slot));
+    as.mov(x86::rax, x86::qword_ptr(x86::rax));
+    emitReturn(as);
+}
+
+void BaselineCompiler::emitBranch(x86::Assembler &as, const Instruction *instr)
+{
+    auto taken = as.newLabel();
+    Register target_pc = instr_pc_ + instr->imm;
+    as.mov(x86::rax, GuestReg(instr->rs1));
+    as.cmp(x86::rax, GuestReg(instr->rs2));
+    switch (instr->inst_id) {
+        case InstructionId::BEQ:
+            as.je(taken);
+            break;
+        case InstructionId::BNE:
+            as.jne(taken);
+            break;
+        case InstructionId::BLT:
+            as.jl(taken);
+            break;
+        case InstructionId::BGE:
+            as.jge(taken);
+            break;
+        case InstructionId::BLTU:
+            as.jb(taken);
+            break;
+        default:
+            as.jae(taken);
+            break;
+    }
+    emitSetPC(as, instr_pc_ + sizeof(uint32_t));
+    emitChainExit(as, instr_pc_ + sizeof(uint32_t));
+    as.bind(taken);
+    emitSetPC(as, target_pc);
+    emitChainExit(as, target_pc);
+}
+
+bool BaselineCompiler::emitInstr(x86::Assembler &as, const Instruction *instr)
+{
+    auto imm = instr->imm;
+    // Result is left in rax
+    switch (instr->inst_id) {
+        case InstructionId::LUI:
+            as.mov(x86::rax, imm);
+            break;
+        case InstructionId::JAL: {
+            Register target_pc = instr_pc_ + imm;
+            if (instr->rd != GPR_file::X0) {
+                as.mov(x86::rax, instr_pc_ + sizeof(uint32_t));
+                as.mov(GuestReg(instr->rd), x86::rax);
+            }
+            emitSetPC(as, target_pc);
+            emitChainExit(as, target_pc);
+            return true;
+        }
+        case InstructionId::JALR:
+            as.mov(x86::rcx, GuestReg(instr->rs1));
+            as.add(x86::rcx, imm);
+            as.and_(x86::rcx, -2);
+            as.mov(GuestReg(GPR_file::PC), x86::rcx);
+            if (instr->rd != GPR_file::X0) {
+                as.mov(x86::rax, instr_pc_ + sizeof(uint32_t));
+                as.mov(GuestReg(instr->rd), x86::rax);
+            }
+            return true;
+        case InstructionId::BEQ:
+        case InstructionId::BNE:
+        case InstructionId::BLT:
+        case InstructionId::BGE:
+        case InstructionId::BLTU:
+        case InstructionId::BGEU:
+            emitBranch(as, instr);
+            return true;
+        case InstructionId::ADDI:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.add(x86::rax, imm);
+            break;
+        case InstructionId::SLTI:
+        case InstructionId::SLTIU:
+            as.xor_(x86::eax, x86::eax);
+            as.cmp(GuestReg(instr->rs1), imm);
+            if (instr->inst_id == InstructionId::SLTI) {
+                as.setl(x86::al);
+            } else {
+                as.setb(x86::al);
+            }
+            break;
+        case InstructionId::XORI:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.xor_(x86::rax, imm);
+            break;
+        case InstructionId::ORI:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.or_(x86::rax, imm);
+            break;
+        case InstructionId::ANDI:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.and_(x86::rax, imm);
+            break;
+        case InstructionId::SLLI:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.shl(x86::rax, imm);
+            break;
+        case InstructionId::SRLI:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.shr(x86::rax, imm);
+            break;
+        case InstructionId::SRAI:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.sar(x86::rax, imm);
+            break;
+        case InstructionId::ADDIW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.add(x86::eax, imm);
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::SLLIW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.shl(x86::eax, imm & 0x1f);
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::SRLIW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.shr(x86::eax, imm & 0x1f);
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::SRAIW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.sar(x86::eax, imm & 0x1f);
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::ADD:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.add(x86::rax, GuestReg(instr->rs2));
+            break;
+        case InstructionId::SUB:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.sub(x86::rax, GuestReg(instr->rs2));
+            break;
+        case InstructionId::XOR:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.xor_(x86::rax, GuestReg(instr->rs2));
+            break;
+        case InstructionId::OR:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.or_(x86::rax, GuestReg(instr->rs2));
+            break;
+        case InstructionId::AND:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.and_(x86::rax, GuestReg(instr->rs2));
+            break;
+        case InstructionId::SLT:
+        case InstructionId::SLTU:
+            as.mov(x86::rcx, GuestReg(instr->rs1));
+            as.xor_(x86::eax, x86::eax);
+            as.cmp(x86::rcx, GuestReg(instr->rs2));
+            if (instr->inst_id == InstructionId::SLT) {
+                as.setl(x86::al);
+            } else {
+                as.setb(x86::al);
+            }
+            break;
+        case InstructionId::SLL:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.mov(x86::rcx, GuestReg(instr->rs2));
+            as.shl(x86::rax, x86::cl);
+            break;
+        case InstructionId::SRL:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.mov(x86::rcx, GuestReg(instr->rs2));
+            as.shr(x86::rax, x86::cl);
+            break;
+        case InstructionId::SRA:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.mov(x86::rcx, GuestReg(instr->rs2));
+            as.sar(x86::rax, x86::cl);
+            break;
+        case InstructionId::ADDW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.add(x86::eax, GuestReg32(instr->rs2));
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::SUBW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.sub(x86::eax, GuestReg32(instr->rs2));
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::SLLW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.mov(x86::ecx, GuestReg32(instr->rs2));
+            as.shl(x86::eax, x86::cl);
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::SRLW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.mov(x86::ecx, GuestReg32(instr->rs2));
+            as.shr(x86::eax, x86::cl);
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::SRAW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.mov(x86::ecx, GuestReg32(instr->rs2));
+            as.sar(x86::eax, x86::cl);
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        case InstructionId::MUL:
+            as.mov(x86::rax, GuestReg(instr->rs1));
+            as.imul(x86::rax, GuestReg(instr->rs2));
+            break;
+        case InstructionId::MULW:
+            as.mov(x86::eax, GuestReg32(instr->rs1));
+            as.imul(x86::eax, GuestReg32(instr->rs2));
+            as.movsxd(x86::rax, x86::eax);
+            break;
+        default:
+            return false;
+    }
+    if (instr->rd != GPR_file::X0)
+        as.mov(GuestReg(instr->rd), x86::rax);
+    return true;
+}
+
+}  // namespace simulator::compiler
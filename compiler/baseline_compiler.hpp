@@ -0,0 +1,44 @@
+#ifndef COMPILER_BASELINE_COMPILER_HPP
+#define COMPILER_BASELINE_COMPILER_HPP
+
+#include <asmjit/asmjit.h>
+#include "configs/macros.hpp"
+#include "interpreter/BB.h"
+#include "interpreter/gpr.h"
+#include "interpreter/instruction.h"
+
+namespace simulator::compiler {
+
+// First tier: stamps out a fixed template per instruction with asmjit::x86::Assembler, so there is no
+// register allocation. Guest registers stay in GPR_file and the PC is known statically
+class BaselineCompiler final {
+public:
+    explicit BaselineCompiler(asmjit::JitRuntime &runtime) : runtime_(runtime) {};
+    NO_COPY_SEMANTIC(BaselineCompiler)
+    NO_MOVE_SEMANTIC(BaselineCompiler)
+
+    // Code counts its runs in *hotness and returns to the dispatcher without executing once the count
+    // reaches optimize_threshold
+    void run(interpreter::CompiledRegion &region, size_t *hotness, size_t optimize_threshold, bool is_cosim);
+
+private:
+    // Returns false if the instruction has no template and must go through the interpreter
+    bool emitInstr(asmjit::x86::Assembler &as, const Instruction *instr);
+    void emitInvoke(asmjit::x86::Assembler &as, size_t instr_offset);
+    void emitSetPC(asmjit::x86::Assembler &as, Register pc);
+    void emitBranch(asmjit::x86::Assembler &as, const Instruction *instr);
+    void emitChainExit(asmjit::x86::Assembler &as, Register target_pc);
+    // Exits account for the instructions retired on their path, the one at the threshold runs nothing
+    void emitRetire(asmjit::x86::Assembler &as);
+    void emitReturn(asmjit::x86::Assembler &as);
+
+    asmjit::JitRuntime &runtime_;
+    interpreter::CompiledRegion *region_ = nullptr;
+    Register instr_pc_ = 0;
+    // Trace instructions retired by an exit taken at the instruction being emitted
+    size_t retired_ = 0;
+};
+
+}  // namespace simulator::compiler
+
+#endif
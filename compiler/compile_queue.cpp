@@ -0,0 +1,184 @@
+#include "compiler/compile_queue.hpp"
+
+#include <algorithm>
+
+namespace simulator::compiler {
+
+CompileQueue::CompileQueue(mem::MMU *mmu, bool is_cosim)
+    : baseline_(runtime_), compiler_(mmu, runtime_, &return_stack_), debug_info_(mmu), is_cosim_(is_cosim)
+{
+    worker_ = std::thread(&CompileQueue::workerLoop, this);
+}
+
+CompileQueue::~CompileQueue()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+}
+
+void CompileQueue::compileBaseline(interpreter::DecodedBB *bb, Register pc, size_t optimize_threshold)
+{
+    interpreter::CompiledRegion region;
+    region.trace.append(bb->getRawData(), bb->size(), pc);
+    auto start = std::chrono::steady_clock::now();
+    baseline_.run(region, bb->getHotnessPtr(), optimize_threshold, is_cosim_);
+    account(stats_.baseline, region, std::chrono::steady_clock::now() - start);
+    install(bb, std::move(region), interpreter::DecodedBB::CompileStatus::BASELINE);
+}
+
+void CompileQueue::push(interpreter::DecodedBB *bb, interpreter::Trace &&trace)
+{
+    Job job {bb, bb->getEpoch(), generation_, {}};
+    job.region.trace = std::move(trace);
+    {
+        std::lock_guard lock(mutex_);
+        pending_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+void CompileQueue::publish()
+{
+    [[likely]] if (!has_finished_.load(std::memory_order_acquire))
+        return;
+
+    std::vector<Job> finished;
+    {
+        std::lock_guard lock(mutex_);
+        finished.swap(finished_);
+        has_finished_.store(false, std::memory_order_relaxed);
+    }
+    for (auto &job : finished) {
+        account(stats_.optimized, job.region, job.compile_time);
+        if (job.bb->getEpoch() != job.epoch) {
+            runtime_.release(job.region.entry);
+            continue;
+        }
+        if (job.generation != generation_) {
+            runtime_.release(job.region.entry);
+            evict(job.bb);
+            continue;
+        }
+        install(job.bb, std::move(job.region), interpreter::DecodedBB::CompileStatus::OPTIMIZED);
+    }
+}
+
+void CompileQueue::evict(interpreter::DecodedBB *bb)
+{
+    if (bb->getCompileStatus() != interpreter::DecodedBB::CompileStatus::RAW)
+        ++stats_.evicted_blocks;
+    release(bb);
+    bb->reset();
+}
+
+void CompileQueue::dropPending()
+{
+    ++generation_;
+}
+
+void CompileQueue::setCodeLimit(size_t bytes)
+{
+    code_limit_ = bytes;
+    enforceCodeLimit(nullptr);
+}
+
+void CompileQueue::install(interpreter::DecodedBB *bb, interpreter::CompiledRegion &&region,
+                           interpreter::DecodedBB::CompileStatus status)
+{
+    release(bb);
+    code_size_ += region.code_size;
+    ++installed_blocks_;
+    installed_.push_back({bb, region.entry});
+    [[unlikely]] if (debug_info_.isEnabled())
+    {
+        bool is_optimized = status == interpreter::DecodedBB::CompileStatus::OPTIMIZED;
+        debug_info_.addCode(reinterpret_cast<const void *>(region.entry), region.code_size,
+                            region.trace.block_pcs.front(), is_optimized ? "opt" : "base");
+    }
+    bb->install(std::move(region), status);
+
+    // Replaced code leaves stale records behind, they are dropped once they outnumber the live ones
+    if (installed_.size() > 2 * installed_blocks_) {
+        std::erase_if(installed_, [](const Installed &record) {
+            return record.bb->getCompiledEntry() != record.entry;
+        });
+    }
+    enforceCodeLimit(bb);
+}
+
+void CompileQueue::release(interpreter::DecodedBB *bb)
+{
+    if (bb->getCompileStatus() == interpreter::DecodedBB::CompileStatus::RAW)
+        return;
+    code_size_ -= bb->getCodeSize();
+    --installed_blocks_;
+    debug_info_.removeCode(reinterpret_cast<const void *>(bb->getCompiledEntry()));
+    runtime_.release(bb->getCompiledEntry());
+    // Return stack entries may point to chain slots of the freed region
+    return_stack_.clear();
+}
+
+JitStats CompileQueue::getStats() const
+{
+    auto stats = stats_;
+    stats.live_code_bytes = code_size_;
+    return stats;
+}
+
+void CompileQueue::account(JitStats::Tier &tier, interpreter::CompiledRegion &region,
+                           std::chrono::nanoseconds compile_time)
+{
+    ++tier.blocks;
+    tier.instrs += region.trace.instrs.size();
+    tier.fallbacks += region.fallbacks.size();
+    tier.code_bytes += region.code_size;
+    tier.compile_time += compile_time;
+    tier.max_compile_time = std::max(tier.max_compile_time, compile_time);
+    for (auto id : region.fallbacks)
+        ++stats_.fallbacks_by_opcode[id];
+    region.fallbacks = {};
+}
+
+void CompileQueue::enforceCodeLimit(interpreter::DecodedBB *keep)
+{
+    while (code_size_ > code_limit_ && !installed_.empty()) {
+        auto record = installed_.front();
+        installed_.pop_front();
+        if (record.bb->getCompiledEntry() != record.entry)
+            continue;
+        if (record.bb == keep) {
+            installed_.push_front(record);
+            return;
+        }
+        evict(record.bb);
+    }
+}
+
+void CompileQueue::workerLoop()
+{
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (stop_)
+                return;
+            job = std::move(pending_.front());
+            pending_.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        compiler_.run(job.region, is_cosim_);
+        job.compile_time = std::chrono::steady_clock::now() - start;
+
+        std::lock_guard lock(mutex_);
+        finished_.push_back(std::move(job));
+        has_finished_.store(true, std::memory_order_release);
+    }
+}
+
+}  // namespace simulator::compiler
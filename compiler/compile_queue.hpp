@@ -0,0 +1,106 @@
+#ifndef COMPILER_COMPILE_QUEUE_HPP
+#define COMPILER_COMPILE_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "compiler/baseline_compiler.hpp"
+#include "compiler/compiler.hpp"
+#include "compiler/jit_debug_info.hpp"
+#include "compiler/jit_stats.hpp"
+#include "configs/macros.hpp"
+#include "interpreter/BB.h"
+#include "memory/includes/mmu.hpp"
+
+namespace simulator::compiler {
+
+// Owns both JIT tiers: baseline code is produced right away on the hart thread, traces are optimized on a
+// background thread while the hart keeps running the baseline code or the interpreter
+class CompileQueue final {
+public:
+    CompileQueue(mem::MMU *mmu, bool is_cosim);
+    ~CompileQueue();
+    NO_COPY_SEMANTIC(CompileQueue)
+    NO_MOVE_SEMANTIC(CompileQueue)
+
+    // Compiles the block itself with the baseline tier, which hands it back once it's worth optimizing
+    void compileBaseline(interpreter::DecodedBB *bb, Register pc, size_t optimize_threshold);
+    // bb keeps its current code until publish() installs the optimized one
+    void push(interpreter::DecodedBB *bb, interpreter::Trace &&trace);
+    // Installs finished code into blocks which weren't reused meanwhile, must be called by the hart thread
+    void publish();
+    // Releases the code of bb and resets its profile, must be called before the block is reused for another PC
+    void evict(interpreter::DecodedBB *bb);
+    // Guest code was overwritten: traces queued so far are dropped and their heads start over
+    void dropPending();
+    // Once installed code exceeds the limit, the oldest blocks are evicted and start over in the interpreter
+    void setCodeLimit(size_t bytes);
+    inline interpreter::ReturnStack &getReturnStack()
+    {
+        return return_stack_;
+    }
+    // Installed code is reported to perf and GDB once enabled here
+    inline JitDebugInfo &getDebugInfo()
+    {
+        return debug_info_;
+    }
+    // Compilation counters of both tiers, the dispatch part is left to the hart
+    JitStats getStats() const;
+
+private:
+    struct Job {
+        interpreter::DecodedBB *bb = nullptr;
+        size_t epoch = 0;
+        size_t generation = 0;
+        interpreter::CompiledRegion region;
+        std::chrono::nanoseconds compile_time {};
+    };
+
+    struct Installed {
+        interpreter::DecodedBB *bb = nullptr;
+        interpreter::DecodedBB::CompiledEntry entry = nullptr;
+    };
+
+    void install(interpreter::DecodedBB *bb, interpreter::CompiledRegion &&region,
+                 interpreter::DecodedBB::CompileStatus status);
+    void release(interpreter::DecodedBB *bb);
+    void account(JitStats::Tier &tier, interpreter::CompiledRegion &region, std::chrono::nanoseconds compile_time);
+    // keep is about to run, so it stays even if it's the oldest one
+    void enforceCodeLimit(interpreter::DecodedBB *keep);
+    void workerLoop();
+
+    // JitAllocator is internally locked, so both tiers may add and release code concurrently
+    asmjit::JitRuntime runtime_;
+    // Shared by all optimized code, which pushes it on calls and pops it on returns
+    interpreter::ReturnStack return_stack_;
+    BaselineCompiler baseline_;
+    Compiler compiler_;
+    JitDebugInfo debug_info_;
+    bool is_cosim_;
+    // Install order, records of code which was replaced or evicted since are skipped
+    std::deque<Installed> installed_;
+    size_t installed_blocks_ = 0;
+    size_t code_size_ = 0;
+    size_t code_limit_ = std::numeric_limits<size_t>::max();
+    // Bumped by dropPending(), jobs from older generations may hold stale instructions
+    size_t generation_ = 0;
+    // Updated by the hart thread only, optimized code is accounted when it's published
+    JitStats stats_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> pending_;
+    std::vector<Job> finished_;
+    // Lets the hart skip locking while nothing is ready
+    std::atomic<bool> has_finished_ = false;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+}  // namespace simulator::compiler
+
+#endif
@@ -1,24 +1,98 @@
 // #include <asmjit/asmjit.h>
 #include <cstddef>
+#include <iostream>
+#include <stdexcept>
 #include "asmjit/core/logger.h"
 #include "bitops.h"
 #include "compiler/compiler.hpp"
+#include "compiler/ir.hpp"
 #include "generated/instructions_enum_gen.h"
 #include "interpreter/BB.h"
 #include "interpreter/gpr.h"
 #include "interpreter/instruction.h"
+#include "interpreter/cosim_trace.h"
 #include "interpreter/executor.h"
+#include "interpreter/fpr.h"
 
 namespace simulator::compiler {
 
-void Compiler::run(interpreter::DecodedBB &decodedBB, bool is_cosim)
+static bool IsChainedTerminator(InstructionId inst_id)
+{
+    switch (inst_id) {
+        case InstructionId::JAL:
+        case InstructionId::BEQ:
+        case InstructionId::BNE:
+        case InstructionId::BLT:
+        case InstructionId::BGE:
+        case InstructionId::BLTU:
+        case InstructionId::BGEU:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool IsDoubleOp(InstructionId inst_id)
+{
+    switch (inst_id) {
+        case InstructionId::FADD_D:
+        case InstructionId::FSUB_D:
+        case InstructionId::FMUL_D:
+        case InstructionId::FDIV_D:
+        case InstructionId::FSQRT_D:
+        case InstructionId::FMADD_D:
+        case InstructionId::FMSUB_D:
+        case InstructionId::FNMSUB_D:
+        case InstructionId::FNMADD_D:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// x1 and x5 are link registers, the ISA hints calls and returns with them
+static bool IsLinkReg(Register_t reg)
+{
+    return reg == GPR_file::X1 || reg == GPR_file::X5;
+}
+
+// Return address stack hints of the ISA: a link rd pushes, a link rs1 pops, both pop and then push
+// unless they are the same register
+static bool IsReturnPop(const Instruction *instr)
+{
+    return IsLinkReg(instr->rs1) && (!IsLinkReg(instr->rd) || instr->rs1 != instr->rd);
+}
+
+static uint8_t *translateIface(mem::MMU *mmu, uintptr_t vaddr)
+{
+    // Unwinding through JIT frames isn't possible, so page faults are fatal here
+    try {
+        return mmu->GetPhysAddrWithAllocation(vaddr);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+        std::abort();
+    }
+}
+
+static uint8_t *storeTranslateIface(mem::MMU *mmu, uintptr_t vaddr)
+{
+    try {
+        return mmu->GetPhysAddrForStore(vaddr);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+        std::abort();
+    }
+}
+
+void Compiler::run(interpreter::CompiledRegion &region, bool is_cosim)
 {
     asmjit::CodeHolder code_holder;
     code_holder.init(runtime_.environment(), runtime_.cpuFeatures());
 
     asmjit::x86::Compiler compiler(&code_holder);
 
-    static auto entry_signature = asmjit::FuncSignatureT<void, interpreter::Executor *, const Instruction *>();
+    static auto entry_signature =
+        asmjit::FuncSignatureT<interpreter::DecodedBB *, interpreter::Executor *, const Instruction *>();
     auto *entry_node = compiler.addFunc(entry_signature);
 
     executor_p_ = compiler.newGpq();
@@ -36,29 +110,61 @@ void Compiler::run(interpreter::DecodedBB &decodedBB, bool is_cosim)
     compiler.mov(registers_p_, executor_p_);
     compiler.add(registers_p_, offset_to_gprf);
 
-    auto body = decodedBB.getBody();
+    region_ = &region;
+    resetRegCache();
+    const auto &trace = region.trace;
+    auto &instrs = trace.instrs;
 
-    for (size_t i = 0; i < body.size(); ++i) {
-        if (body[i].inst_id == InstructionId::BB_END_INST)
-            break;
-        if (is_cosim) {
-            compileInvoke(compiler, interpreter::runInstrIface, i);
-        } else {
-            compileInstr(compiler, &body[i], i);
+    // Cosimulation records every instruction, so nothing is optimized away
+    auto ir = is_cosim ? Optimizer::build(trace) : Optimizer::run(trace);
+    for (const auto &inst : ir) {
+        instr_pc_ = trace.pcs[inst.index];
+        retired_ = inst.index + 1;
+        auto next = inst.index + 1;
+        next_pc_ = next < instrs.size() ? std::optional<Register>(trace.pcs[next]) : std::nullopt;
+        switch (inst.kind) {
+            case IrInst::Kind::GUEST:
+                if (is_cosim) {
+                    compileTracedInstr(compiler, &inst.instr, inst.index);
+                } else {
+                    compileInstr(compiler, &inst.instr, inst.index);
+                }
+                break;
+            case IrInst::Kind::CONST:
+                compileSetReg(compiler, inst.instr.rd, inst.value);
+                break;
+            case IrInst::Kind::JUMP:
+                compileJump(compiler, &inst.instr, inst.value);
+                break;
+            case IrInst::Kind::NOP:
+                break;
         }
     }
 
+    // Branches and jumps emit their own exits
+    auto last_id = instrs.empty() ? InstructionId::BB_END_INST : instrs.back().inst_id;
+    bool has_exit = IsChainedTerminator(last_id) || last_id == InstructionId::JALR;
+    retired_ = instrs.size();
+    // FENCE.I goes back to the dispatcher, which drops stale translations before anything else runs
+    if (last_id == InstructionId::FENCE_I) {
+        compileIndirectExit(compiler);
+    } else if (!has_exit) {
+        compileChainExit(compiler, instr_pc_ + sizeof(uint32_t));
+    }
+
     compiler.endFunc();
     compiler.finalize();
-    interpreter::DecodedBB::CompiledEntry entry = nullptr;
-    runtime_.add(&entry, &code_holder);
-    decodedBB.setCompiledEntry(entry);
-    decodedBB.setCompileStatus(interpreter::DecodedBB::CompileStatus::COMPILED);
+    region.code_size = code_holder.codeSize();
+    runtime_.add(&region.entry, &code_holder);
 }
 
-void Compiler::compileInvoke(asmjit::x86::Compiler &compiler, const interpreter::DecodedBB::CompiledEntry executor,
-                             size_t instr_offset)
+void Compiler::compileInvoke(asmjit::x86::Compiler &compiler, const InvokeEntry executor, size_t instr_offset)
 {
+    // The interpreter works on GPR_file, so it has to see every cached write and may change any register
+    region_->fallbacks.push_back(region_->trace.instrs[instr_offset].inst_id);
+    compileSetPC(compiler, instr_pc_);
+    compileWriteBack(compiler);
+
     auto instr = compiler.newGpq();
     compiler.mov(instr, instruction_p_);
     compiler.add(instr, sizeof(Instruction) * instr_offset);
@@ -68,45 +174,131 @@ void Compiler::compileInvoke(asmjit::x86::Compiler &compiler, const interpreter:
     compiler.invoke(&invokeNode, executor, executor_signature);
     invokeNode->setArg(0, executor_p_);
     invokeNode->setArg(1, instr);
+
+    resetRegCache();
 }
 
-asmjit::x86::Gp Compiler::compileGetReg(asmjit::x86::Compiler &compiler, size_t index)
+void Compiler::compileTracedInstr(asmjit::x86::Compiler &compiler, const Instruction *instr, size_t instr_offset)
 {
-    auto reg = compiler.newGpq();
-    compiler.mov(reg, asmjit::x86::qword_ptr(registers_p_, sizeof(Register) * index));
-    return reg;
+    auto reg = interpreter::GetTracedReg(*instr);
+    // Branches and jumps may leave the block, so they are recorded first, the link value is known anyway
+    if (IsChainedTerminator(instr->inst_id) || instr->inst_id == InstructionId::JALR) {
+        auto value = compiler.newGpq();
+        compiler.mov(value, reg == GPR_file::X0 ? 0 : instr_pc_ + sizeof(uint32_t));
+        compileTraceRecord(compiler, reg, value);
+        compileInstr(compiler, instr, instr_offset);
+        return;
+    }
+
+    // Instructions run by the interpreter are recorded by it
+    auto fallbacks = region_->fallbacks.size();
+    compileInstr(compiler, instr, instr_offset);
+    if (region_->fallbacks.size() != fallbacks)
+        return;
+    if (reg < interpreter::CosimTrace::FPR_BASE) {
+        compileTraceRecord(compiler, reg, compileUseReg(compiler, reg));
+    } else {
+        auto value = compiler.newGpq();
+        compiler.mov(value, getFprPtr(reg - interpreter::CosimTrace::FPR_BASE, sizeof(uint64_t)));
+        compileTraceRecord(compiler, reg, value);
+    }
 }
 
-asmjit::x86::Gp Compiler::compileGetPC(asmjit::x86::Compiler &compiler)
+void Compiler::compileTraceRecord(asmjit::x86::Compiler &compiler, uint8_t reg, asmjit::x86::Gp value)
 {
+    using interpreter::CosimRecord;
+    using interpreter::CosimTrace;
+
+    auto trace = compiler.newGpq();
+    compiler.lea(trace, asmjit::x86::ptr(executor_p_, interpreter::Executor::getOffsetToCosimTrace()));
+    auto cursor = compiler.newGpq();
+    compiler.mov(cursor, asmjit::x86::qword_ptr(trace, CosimTrace::getOffsetToCursor()));
     auto pc = compiler.newGpq();
-    compiler.mov(pc, asmjit::x86::qword_ptr(pc_p_));
-    return pc;
+    compiler.mov(pc, instr_pc_);
+    compiler.mov(asmjit::x86::qword_ptr(cursor, offsetof(CosimRecord, pc)), pc);
+    compiler.mov(asmjit::x86::qword_ptr(cursor, offsetof(CosimRecord, value)), value);
+    compiler.mov(asmjit::x86::byte_ptr(cursor, offsetof(CosimRecord, reg)), reg);
+    compiler.add(cursor, sizeof(CosimRecord));
+    compiler.mov(asmjit::x86::qword_ptr(trace, CosimTrace::getOffsetToCursor()), cursor);
+
+    // Flushing doesn't touch guest state, so cached registers stay valid across the call
+    auto done = compiler.newLabel();
+    compiler.cmp(cursor, asmjit::x86::qword_ptr(trace, CosimTrace::getOffsetToEnd()));
+    compiler.jne(done);
+    static auto flush_signature = asmjit::FuncSignatureT<void, CosimTrace *>();
+    asmjit::InvokeNode *invokeNode = nullptr;
+    compiler.invoke(&invokeNode, interpreter::flushCosimTraceIface, flush_signature);
+    invokeNode->setArg(0, trace);
+    compiler.bind(done);
 }
 
-void Compiler::compileSetReg(asmjit::x86::Compiler &compiler, size_t index, asmjit::x86::Gp reg)
+void Compiler::resetRegCache()
+{
+    loaded_regs_.reset();
+    dirty_regs_.reset();
+}
+
+asmjit::x86::Gp Compiler::compileUseReg(asmjit::x86::Compiler &compiler, size_t index)
+{
+    if (!loaded_regs_.test(index)) {
+        guest_regs_[index] = compiler.newGpq();
+        if (index == GPR_file::X0) {
+            compiler.xor_(guest_regs_[index], guest_regs_[index]);
+        } else {
+            compiler.mov(guest_regs_[index], asmjit::x86::qword_ptr(registers_p_, sizeof(Register) * index));
+        }
+        loaded_regs_.set(index);
+    }
+    return guest_regs_[index];
+}
+
+asmjit::x86::Gp Compiler::compileGetReg(asmjit::x86::Compiler &compiler, size_t index)
 {
-    compiler.mov(asmjit::x86::qword_ptr(registers_p_, sizeof(Register) * index), reg);
+    auto reg = compiler.newGpq();
+    compiler.mov(reg, compileUseReg(compiler, index));
+    return reg;
 }
 
-void Compiler::compileSetReg(asmjit::x86::Compiler &compiler, size_t index, Immediate_t imm)
+void Compiler::compileSetReg(asmjit::x86::Compiler &compiler, size_t index, asmjit::x86::Gp reg)
 {
-    compiler.mov(asmjit::x86::qword_ptr(registers_p_, sizeof(Register) * index), imm);
+    // Writes to x0 are dropped at compile time instead of being masked by GPR_file::write
+    if (index == GPR_file::X0)
+        return;
+    if (!loaded_regs_.test(index)) {
+        guest_regs_[index] = compiler.newGpq();
+        loaded_regs_.set(index);
+    }
+    compiler.mov(guest_regs_[index], reg);
+    dirty_regs_.set(index);
 }
 
-void Compiler::compileIncrementPC(asmjit::x86::Compiler &compiler)
+void Compiler::compileSetReg(asmjit::x86::Compiler &compiler, size_t index, Register imm)
 {
-    compiler.add(asmjit::x86::qword_ptr(pc_p_), 4);
+    if (index == GPR_file::X0)
+        return;
+    if (!loaded_regs_.test(index)) {
+        guest_regs_[index] = compiler.newGpq();
+        loaded_regs_.set(index);
+    }
+    compiler.mov(guest_regs_[index], imm);
+    dirty_regs_.set(index);
 }
 
-void Compiler::compileIncrementPC(asmjit::x86::Compiler &compiler, Immediate_t imm)
+void Compiler::compileWriteBack(asmjit::x86::Compiler &compiler)
 {
-    compiler.add(asmjit::x86::qword_ptr(pc_p_), imm);
+    // Cache state is left untouched: every exit of a branch writes back the same set
+    for (size_t index = 0; index < GUEST_REGS_NUM; ++index) {
+        if (dirty_regs_.test(index))
+            compiler.mov(asmjit::x86::qword_ptr(registers_p_, sizeof(Register) * index), guest_regs_[index]);
+    }
 }
 
-void Compiler::compileSetPC(asmjit::x86::Compiler &compiler, Immediate_t imm)
+void Compiler::compileSetPC(asmjit::x86::Compiler &compiler, Register pc)
 {
-    compiler.mov(asmjit::x86::qword_ptr(pc_p_), imm);
+    // There is no move of a 64-bit immediate to memory
+    auto reg = compiler.newGpq();
+    compiler.mov(reg, pc);
+    compiler.mov(asmjit::x86::qword_ptr(pc_p_), reg);
 }
 
 void Compiler::compileSetPC(asmjit::x86::Compiler &compiler, asmjit::x86::Gp pc)
@@ -114,230 +306,424 @@ void Compiler::compileSetPC(asmjit::x86::Compiler &compiler, asmjit::x86::Gp pc)
     compiler.mov(asmjit::x86::qword_ptr(pc_p_), pc);
 }
 
+void Compiler::compileChainExit(asmjit::x86::Compiler &compiler, Register target_pc)
+{
+    auto *slot = region_->addSuccessor(target_pc);
+    compileSetPC(compiler, target_pc);
+    compileWriteBack(compiler);
+    compileRetire(compiler);
+    // The slot is patched by the dispatcher once the target gets compiled
+    auto next = compiler.newGpq();
+    compiler.mov(next, reinterpret_cast<uint64_t>(slot));
+    compiler.mov(next, asmjit::x86::qword_ptr(next));
+    compiler.ret(next);
+}
+
+void Compiler::compileBranchExits(asmjit::x86::Compiler &compiler, asmjit::Label not_taken, SRegister offset)
+{
+    // Inside a trace the recorded direction goes on inline and the other one becomes a side exit
+    auto cont = compiler.newLabel();
+    if (next_pc_ == instr_pc_ + offset) {
+        compiler.jmp(cont);
+    } else {
+        compileChainExit(compiler, instr_pc_ + offset);
+    }
+    compiler.bind(not_taken);
+    if (next_pc_ != instr_pc_ + sizeof(uint32_t))
+        compileChainExit(compiler, instr_pc_ + sizeof(uint32_t));
+    compiler.bind(cont);
+}
+
+void Compiler::compileRetire(asmjit::x86::Compiler &compiler)
+{
+    auto offset = interpreter::Executor::getOffsetToCompiledInstrs();
+    compiler.add(asmjit::x86::qword_ptr(executor_p_, offset), retired_);
+}
+
+void Compiler::compileIndirectExit(asmjit::x86::Compiler &compiler)
+{
+    compileWriteBack(compiler);
+    compileRetire(compiler);
+    auto next = compiler.newGpq();
+    compiler.xor_(next, next);
+    compiler.ret(next);
+}
+
+void Compiler::compileCachedExit(asmjit::x86::Compiler &compiler, asmjit::x86::Gp target)
+{
+    compileWriteBack(compiler);
+    compileRetire(compiler);
+    // The dispatcher refills the cache on a miss
+    auto *cache = region_->addInlineCache();
+    auto cache_p = compiler.newGpq();
+    compiler.mov(cache_p, reinterpret_cast<uint64_t>(cache));
+    auto next = compiler.newGpq();
+    compiler.xor_(next, next);
+    auto miss = compiler.newLabel();
+    compiler.cmp(target, asmjit::x86::qword_ptr(cache_p, offsetof(interpreter::InlineCache, pc)));
+    compiler.jne(miss);
+    compiler.mov(next, asmjit::x86::qword_ptr(cache_p, offsetof(interpreter::InlineCache, target)));
+    compiler.bind(miss);
+    compiler.ret(next);
+}
+
+void Compiler::compileReturnExit(asmjit::x86::Compiler &compiler, asmjit::x86::Gp target,
+                                 std::optional<Register> return_pc)
+{
+    using Entry = interpreter::ReturnStack::Entry;
+    compileWriteBack(compiler);
+    compileRetire(compiler);
+
+    auto stack = compiler.newGpq();
+    compiler.mov(stack, reinterpret_cast<uint64_t>(return_stack_));
+    auto top = compiler.newGpq();
+    compiler.mov(top, asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, top)));
+    auto entry = compiler.newGpq();
+    compiler.mov(entry, top);
+    compiler.shl(entry, GetPowerOfTwo<sizeof(Entry)>());
+    compiler.add(entry, stack);
+    compiler.dec(top);
+    compiler.and_(top, interpreter::ReturnStack::SIZE - 1);
+    compiler.mov(asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, top)), top);
+
+    auto next = compiler.newGpq();
+    compiler.xor_(next, next);
+    auto done = compiler.newLabel();
+    auto entries = offsetof(interpreter::ReturnStack, entries);
+    compiler.cmp(target, asmjit::x86::qword_ptr(entry, entries + offsetof(Entry, pc)));
+    compiler.jne(done);
+    auto slot = compiler.newGpq();
+    compiler.mov(slot, asmjit::x86::qword_ptr(entry, entries + offsetof(Entry, slot)));
+    compiler.mov(next, asmjit::x86::qword_ptr(slot));
+    compiler.test(next, next);
+    compiler.jnz(done);
+    // Predicted right, but the return site isn't linked yet
+    compiler.mov(asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, miss_slot)), slot);
+    compiler.mov(asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, miss_pc)), target);
+    compiler.bind(done);
+    if (return_pc)
+        compilePushReturn(compiler, *return_pc);
+    compiler.ret(next);
+}
+
+void Compiler::compilePopReturn(asmjit::x86::Compiler &compiler)
+{
+    auto stack = compiler.newGpq();
+    compiler.mov(stack, reinterpret_cast<uint64_t>(return_stack_));
+    auto top = compiler.newGpq();
+    compiler.mov(top, asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, top)));
+    compiler.dec(top);
+    compiler.and_(top, interpreter::ReturnStack::SIZE - 1);
+    compiler.mov(asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, top)), top);
+}
+
+void Compiler::compilePushReturn(asmjit::x86::Compiler &compiler, Register return_pc)
+{
+    using Entry = interpreter::ReturnStack::Entry;
+    auto *slot = region_->addSuccessor(return_pc);
+
+    auto stack = compiler.newGpq();
+    compiler.mov(stack, reinterpret_cast<uint64_t>(return_stack_));
+    auto top = compiler.newGpq();
+    compiler.mov(top, asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, top)));
+    compiler.inc(top);
+    compiler.and_(top, interpreter::ReturnStack::SIZE - 1);
+    compiler.mov(asmjit::x86::qword_ptr(stack, offsetof(interpreter::ReturnStack, top)), top);
+    compiler.shl(top, GetPowerOfTwo<sizeof(Entry)>());
+    compiler.add(top, stack);
+
+    auto entries = offsetof(interpreter::ReturnStack, entries);
+    auto value = compiler.newGpq();
+    compiler.mov(value, return_pc);
+    compiler.mov(asmjit::x86::qword_ptr(top, entries + offsetof(Entry, pc)), value);
+    compiler.mov(value, reinterpret_cast<uint64_t>(slot));
+    compiler.mov(asmjit::x86::qword_ptr(top, entries + offsetof(Entry, slot)), value);
+}
+
+asmjit::x86::Gp Compiler::compileTranslate(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_store)
+{
+    auto miss = compiler.newLabel();
+    auto done = compiler.newLabel();
+
+    auto vaddr = compiler.newGpq();
+    compiler.lea(vaddr, asmjit::x86::qword_ptr(compileUseReg(compiler, instr->rs1), static_cast<int32_t>(instr->imm)));
+
+    // Same indexing as MMU::CheckInTlb: virtual page number modulo TLB size
+    auto entry = compiler.newGpq();
+    compiler.mov(entry, vaddr);
+    compiler.shr(entry, mem::Page::OFFSET_BIT_LENGTH);
+    compiler.and_(entry, mem::MMU::TLB_SIZE - 1);
+    compiler.shl(entry, GetPowerOfTwo<sizeof(mem::MMU::TlbEntry)>());
+    auto tlb = compiler.newGpq();
+    compiler.mov(tlb, reinterpret_cast<uint64_t>(is_store ? mmu_->GetStoreTlb() : mmu_->GetTlb()));
+    compiler.add(entry, tlb);
+
+    auto tag = compiler.newGpq();
+    compiler.mov(tag, vaddr);
+    compiler.and_(tag, mem::Page::ID_MASK);
+    compiler.cmp(tag, asmjit::x86::qword_ptr(entry, offsetof(mem::MMU::TlbEntry, vaddr)));
+    compiler.jne(miss);
+
+    auto host = compiler.newGpq();
+    compiler.mov(host, vaddr);
+    compiler.and_(host, mem::Page::OFFSET_MASK);
+    compiler.add(host, asmjit::x86::qword_ptr(entry, offsetof(mem::MMU::TlbEntry, paddr)));
+    auto mem_base = compiler.newGpq();
+    compiler.mov(mem_base, reinterpret_cast<uint64_t>(mmu_->GetMemPointer()));
+    compiler.add(host, mem_base);
+    compiler.jmp(done);
+
+    // The page walk doesn't touch guest registers, so the register cache stays valid.
+    // PC is stored to keep the guest state precise if the walk faults
+    compiler.bind(miss);
+    compileSetPC(compiler, instr_pc_);
+    auto mmu = compiler.newGpq();
+    compiler.mov(mmu, reinterpret_cast<uint64_t>(mmu_));
+    static auto translate_signature = asmjit::FuncSignatureT<uint8_t *, mem::MMU *, uintptr_t>();
+    asmjit::InvokeNode *invokeNode = nullptr;
+    compiler.invoke(&invokeNode, is_store ? storeTranslateIface : translateIface, translate_signature);
+    invokeNode->setArg(0, mmu);
+    invokeNode->setArg(1, vaddr);
+    invokeNode->setRet(0, host);
+
+    compiler.bind(done);
+    return host;
+}
+
 void Compiler::compileADDI(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    compiler.add(op1, GetSignedExtension<Register, 12>(instr->imm));
+    compiler.add(op1, instr->imm);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileLUI(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     compileSetReg(compiler, instr->rd, instr->imm);
-    compileIncrementPC(compiler);
+}
+
+void Compiler::compileAUIPC(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    compileSetReg(compiler, instr->rd, instr_pc_ + instr->imm);
 }
 
 void Compiler::compileBEQ(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto label = compiler.newLabel();
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto offset = instr->imm;
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.cmp(op1, op2);
     compiler.jne(label);
-    compileIncrementPC(compiler, GetSignedExtension<Register, 12>(instr->imm) - 4);
-    compiler.bind(label);
-    compileIncrementPC(compiler);
+    compileBranchExits(compiler, label, offset);
 }
 
 void Compiler::compileBNE(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto label = compiler.newLabel();
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto offset = instr->imm;
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.cmp(op1, op2);
     compiler.je(label);
-    compileIncrementPC(compiler, GetSignedExtension<Register, 12>(instr->imm) - 4);
-    compiler.bind(label);
-    compileIncrementPC(compiler);
+    compileBranchExits(compiler, label, offset);
 }
 
 void Compiler::compileBLT(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto label = compiler.newLabel();
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto offset = instr->imm;
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.cmp(op1, op2);
     compiler.jge(label);
-    compileIncrementPC(compiler, GetSignedExtension<Register, 12>(instr->imm) - 4);
-    compiler.bind(label);
-    compileIncrementPC(compiler);
+    compileBranchExits(compiler, label, offset);
 }
 
 void Compiler::compileBLTU(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto label = compiler.newLabel();
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto offset = instr->imm;
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.cmp(op1, op2);
     compiler.jae(label);
-    compileIncrementPC(compiler, GetSignedExtension<Register, 12>(instr->imm) - 4);
-    compiler.bind(label);
-    compileIncrementPC(compiler);
+    compileBranchExits(compiler, label, offset);
 }
 
 void Compiler::compileBGE(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto label = compiler.newLabel();
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto offset = instr->imm;
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.cmp(op1, op2);
     compiler.jl(label);
-    compileIncrementPC(compiler, GetSignedExtension<Register, 12>(instr->imm) - 4);
-    compiler.bind(label);
-    compileIncrementPC(compiler);
+    compileBranchExits(compiler, label, offset);
 }
 
 void Compiler::compileBGEU(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto label = compiler.newLabel();
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto offset = instr->imm;
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.cmp(op1, op2);
     compiler.jb(label);
-    compileIncrementPC(compiler, GetSignedExtension<Register, 12>(instr->imm) - 4);
-    compiler.bind(label);
-    compileIncrementPC(compiler);
+    compileBranchExits(compiler, label, offset);
 }
 
 void Compiler::compileJALR(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
-    auto pc = compileGetPC(compiler);
-    compiler.add(pc, 4);
+    // JALR ends every trace, so it always exits
     auto op1 = compileGetReg(compiler, instr->rs1);
     compiler.add(op1, instr->imm);
     compiler.and_(op1, ~1ULL);
-    compileSetReg(compiler, instr->rd, pc);
+    compileSetReg(compiler, instr->rd, instr_pc_ + sizeof(uint32_t));
     compileSetPC(compiler, op1);
+    auto return_pc = IsLinkReg(instr->rd) ? std::optional<Register>(instr_pc_ + sizeof(uint32_t)) : std::nullopt;
+    if (IsReturnPop(instr)) {
+        compileReturnExit(compiler, op1, return_pc);
+        return;
+    }
+    if (return_pc)
+        compilePushReturn(compiler, *return_pc);
+    compileCachedExit(compiler, op1);
 }
 
 void Compiler::compileJAL(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
-    auto pc = compileGetPC(compiler);
-    compileSetReg(compiler, instr->rd, pc);
-    auto advanced_pc = compileGetReg(compiler, instr->rd);
-    compiler.add(advanced_pc, 4);
-    compiler.add(pc, GetSignedExtension<Register, 20>(instr->imm));
-    compileSetReg(compiler, instr->rd, advanced_pc);
-    compileSetPC(compiler, pc);
+    auto offset = instr->imm;
+    compileSetReg(compiler, instr->rd, instr_pc_ + sizeof(uint32_t));
+    if (IsLinkReg(instr->rd))
+        compilePushReturn(compiler, instr_pc_ + sizeof(uint32_t));
+    if (next_pc_ != instr_pc_ + offset)
+        compileChainExit(compiler, instr_pc_ + offset);
+}
+
+void Compiler::compileJump(asmjit::x86::Compiler &compiler, const Instruction *instr, Register target)
+{
+    compileSetReg(compiler, instr->rd, instr_pc_ + sizeof(uint32_t));
+    // Target is known, but the stack has to stay in step with the returns
+    if (IsReturnPop(instr))
+        compilePopReturn(compiler);
+    if (IsLinkReg(instr->rd))
+        compilePushReturn(compiler, instr_pc_ + sizeof(uint32_t));
+    if (next_pc_ != target)
+        compileChainExit(compiler, target);
 }
 
 void Compiler::compileSLLI(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto rs = compileGetReg(compiler, instr->rs1);
-    compiler.shl(rs, instr->GetShamt());
+    compiler.shl(rs, instr->imm);
     compileSetReg(compiler, instr->rd, rs);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSLL(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
-    compiler.shl(op1, op2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.shl(op1, op2.r8());
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSLT(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    auto res = compiler.newGpq();
+    compiler.xor_(res, res);
     compiler.cmp(op1, op2);
-    compiler.setl(op1);
-    compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
+    compiler.setl(res.r8());
+    compileSetReg(compiler, instr->rd, res);
 }
 
 void Compiler::compileSLTU(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
-    auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    auto res = compiler.newGpq();
+    compiler.xor_(res, res);
     compiler.cmp(op1, op2);
-    compiler.setb(op1);
-    compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
+    compiler.setb(res.r8());
+    compileSetReg(compiler, instr->rd, res);
 }
 
 void Compiler::compileXOR(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.xor_(op1, op2);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSRL(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
-    compiler.shr(op1, op2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.shr(op1, op2.r8());
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileOR(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.or_(op1, op2);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileAND(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.and_(op1, op2);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSUB(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.sub(op1, op2);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSRA(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
-    compiler.sar(op1, op2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.sar(op1, op2.r8());
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileADD(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    auto op2 = compileGetReg(compiler, instr->rs2);
+    auto op2 = compileUseReg(compiler, instr->rs2);
     compiler.add(op1, op2);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSLTI(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
-    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto res = compiler.newGpq();
+    compiler.xor_(res, res);
     compiler.cmp(op1, instr->imm);
-    compiler.setl(op1);
-    compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
+    compiler.setl(res.r8());
+    compileSetReg(compiler, instr->rd, res);
 }
 
 void Compiler::compileSLTIU(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
-    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto res = compiler.newGpq();
+    compiler.xor_(res, res);
     compiler.cmp(op1, instr->imm);
-    compiler.setb(op1);
-    compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
+    compiler.setb(res.r8());
+    compileSetReg(compiler, instr->rd, res);
 }
 
 void Compiler::compileXORI(asmjit::x86::Compiler &compiler, const Instruction *instr)
@@ -345,7 +731,6 @@ void Compiler::compileXORI(asmjit::x86::Compiler &compiler, const Instruction *i
     auto op1 = compileGetReg(compiler, instr->rs1);
     compiler.xor_(op1, instr->imm);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSRLI(asmjit::x86::Compiler &compiler, const Instruction *instr)
@@ -353,7 +738,6 @@ void Compiler::compileSRLI(asmjit::x86::Compiler &compiler, const Instruction *i
     auto op1 = compileGetReg(compiler, instr->rs1);
     compiler.shr(op1, instr->imm);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileSRAI(asmjit::x86::Compiler &compiler, const Instruction *instr)
@@ -361,7 +745,6 @@ void Compiler::compileSRAI(asmjit::x86::Compiler &compiler, const Instruction *i
     auto op1 = compileGetReg(compiler, instr->rs1);
     compiler.sar(op1, instr->imm);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileORI(asmjit::x86::Compiler &compiler, const Instruction *instr)
@@ -369,7 +752,6 @@ void Compiler::compileORI(asmjit::x86::Compiler &compiler, const Instruction *in
     auto op1 = compileGetReg(compiler, instr->rs1);
     compiler.or_(op1, instr->imm);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileANDI(asmjit::x86::Compiler &compiler, const Instruction *instr)
@@ -377,16 +759,470 @@ void Compiler::compileANDI(asmjit::x86::Compiler &compiler, const Instruction *i
     auto op1 = compileGetReg(compiler, instr->rs1);
     compiler.and_(op1, instr->imm);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
 }
 
 void Compiler::compileADDIW(asmjit::x86::Compiler &compiler, const Instruction *instr)
 {
     auto op1 = compileGetReg(compiler, instr->rs1);
-    compiler.add(op1, GetSignedExtension<Register, 12>(instr->imm));
-    compiler.movsx(op1, op1);
+    compiler.add(op1, instr->imm);
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileSLLIW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    compiler.shl(op1.r32(), instr->imm & 0x1f);
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileSRLIW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    compiler.shr(op1.r32(), instr->imm & 0x1f);
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileSRAIW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    compiler.sar(op1.r32(), instr->imm & 0x1f);
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileADDW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.add(op1.r32(), op2.r32());
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileSUBW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.sub(op1.r32(), op2.r32());
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileSLLW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.shl(op1.r32(), op2.r8());
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileSRLW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.shr(op1.r32(), op2.r8());
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileSRAW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.sar(op1.r32(), op2.r8());
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileLB(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr);
+    compiler.movsx(host, asmjit::x86::byte_ptr(host));
+    compileSetReg(compiler, instr->rd, host);
+}
+
+void Compiler::compileLH(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr);
+    compiler.movsx(host, asmjit::x86::word_ptr(host));
+    compileSetReg(compiler, instr->rd, host);
+}
+
+void Compiler::compileLW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr);
+    compiler.movsxd(host, asmjit::x86::dword_ptr(host));
+    compileSetReg(compiler, instr->rd, host);
+}
+
+void Compiler::compileLD(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr);
+    compiler.mov(host, asmjit::x86::qword_ptr(host));
+    compileSetReg(compiler, instr->rd, host);
+}
+
+void Compiler::compileLBU(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr);
+    compiler.movzx(host.r32(), asmjit::x86::byte_ptr(host));
+    compileSetReg(compiler, instr->rd, host);
+}
+
+void Compiler::compileLHU(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr);
+    compiler.movzx(host.r32(), asmjit::x86::word_ptr(host));
+    compileSetReg(compiler, instr->rd, host);
+}
+
+void Compiler::compileLWU(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr);
+    // 32-bit move zeroes the upper half
+    compiler.mov(host.r32(), asmjit::x86::dword_ptr(host));
+    compileSetReg(compiler, instr->rd, host);
+}
+
+void Compiler::compileSB(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr, true);
+    compiler.mov(asmjit::x86::byte_ptr(host), compileUseReg(compiler, instr->rs2).r8());
+}
+
+void Compiler::compileSH(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr, true);
+    compiler.mov(asmjit::x86::word_ptr(host), compileUseReg(compiler, instr->rs2).r16());
+}
+
+void Compiler::compileSW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr, true);
+    compiler.mov(asmjit::x86::dword_ptr(host), compileUseReg(compiler, instr->rs2).r32());
+}
+
+void Compiler::compileSD(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto host = compileTranslate(compiler, instr, true);
+    compiler.mov(asmjit::x86::qword_ptr(host), compileUseReg(compiler, instr->rs2));
+}
+
+std::pair<asmjit::x86::Gp, asmjit::x86::Gp> Compiler::compileDivRem(asmjit::x86::Compiler &compiler,
+                                                                    const Instruction *instr, bool is_signed,
+                                                                    bool is_word)
+{
+    auto sized = [is_word](asmjit::x86::Gp reg) { return is_word ? reg.r32() : reg; };
+
+    auto quot = compileGetReg(compiler, instr->rs1);
+    auto divisor = compileGetReg(compiler, instr->rs2);
+    auto rem = compiler.newGpq();
+    auto tmp = compiler.newGpq();
+    auto one = compiler.newGpq();
+    compiler.mov(one, 1);
+
+    // Special cases are handled without branches: the divisor is replaced so that the
+    // hardware division can't trap, then the results are patched with cmov
+    if (is_signed) {
+        // x / -1 == -x, and negation wraps the most negative value the way RISC-V requires
+        compiler.mov(tmp, quot);
+        compiler.neg(sized(tmp));
+        compiler.cmp(sized(divisor), -1);
+        compiler.cmove(sized(quot), sized(tmp));
+        compiler.cmove(sized(divisor), sized(one));
+    }
+    compiler.test(sized(divisor), sized(divisor));
+    compiler.cmovz(sized(divisor), sized(one));
+
+    if (is_signed) {
+        if (is_word) {
+            compiler.cdq(rem.r32(), quot.r32());
+        } else {
+            compiler.cqo(rem, quot);
+        }
+        compiler.idiv(sized(rem), sized(quot), sized(divisor));
+    } else {
+        compiler.xor_(rem.r32(), rem.r32());
+        compiler.div(sized(rem), sized(quot), sized(divisor));
+    }
+
+    // Division by zero gives all ones and leaves the dividend as the remainder
+    auto orig_divisor = compileUseReg(compiler, instr->rs2);
+    compiler.mov(tmp, -1);
+    compiler.test(sized(orig_divisor), sized(orig_divisor));
+    compiler.cmovz(quot, tmp);
+    compiler.cmovz(rem, compileUseReg(compiler, instr->rs1));
+
+    if (is_word) {
+        compiler.movsxd(quot, quot.r32());
+        compiler.movsxd(rem, rem.r32());
+    }
+    return {quot, rem};
+}
+
+void Compiler::compileMUL(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.imul(op1, op2);
     compileSetReg(compiler, instr->rd, op1);
-    compileIncrementPC(compiler);
+}
+
+void Compiler::compileMULH(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto lo = compileGetReg(compiler, instr->rs1);
+    auto hi = compiler.newGpq();
+    compiler.imul(hi, lo, compileUseReg(compiler, instr->rs2));
+    compileSetReg(compiler, instr->rd, hi);
+}
+
+void Compiler::compileMULHSU(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileUseReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    auto lo = compiler.newGpq();
+    auto hi = compiler.newGpq();
+    compiler.mov(lo, op1);
+    compiler.mul(hi, lo, op2);
+    // Signed high half is the unsigned one minus rs2 when rs1 is negative
+    auto correction = compiler.newGpq();
+    compiler.mov(correction, op1);
+    compiler.sar(correction, 63);
+    compiler.and_(correction, op2);
+    compiler.sub(hi, correction);
+    compileSetReg(compiler, instr->rd, hi);
+}
+
+void Compiler::compileMULHU(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto lo = compileGetReg(compiler, instr->rs1);
+    auto hi = compiler.newGpq();
+    compiler.mul(hi, lo, compileUseReg(compiler, instr->rs2));
+    compileSetReg(compiler, instr->rd, hi);
+}
+
+void Compiler::compileDIV(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, true, false);
+    compileSetReg(compiler, instr->rd, quot);
+}
+
+void Compiler::compileDIVU(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, false, false);
+    compileSetReg(compiler, instr->rd, quot);
+}
+
+void Compiler::compileREM(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, true, false);
+    compileSetReg(compiler, instr->rd, rem);
+}
+
+void Compiler::compileREMU(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, false, false);
+    compileSetReg(compiler, instr->rd, rem);
+}
+
+void Compiler::compileMULW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto op1 = compileGetReg(compiler, instr->rs1);
+    auto op2 = compileUseReg(compiler, instr->rs2);
+    compiler.imul(op1.r32(), op2.r32());
+    compiler.movsxd(op1, op1.r32());
+    compileSetReg(compiler, instr->rd, op1);
+}
+
+void Compiler::compileDIVW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, true, true);
+    compileSetReg(compiler, instr->rd, quot);
+}
+
+void Compiler::compileDIVUW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, false, true);
+    compileSetReg(compiler, instr->rd, quot);
+}
+
+void Compiler::compileREMW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, true, true);
+    compileSetReg(compiler, instr->rd, rem);
+}
+
+void Compiler::compileREMUW(asmjit::x86::Compiler &compiler, const Instruction *instr)
+{
+    auto [quot, rem] = compileDivRem(compiler, instr, false, true);
+    compileSetReg(compiler, instr->rd, rem);
+}
+
+asmjit::x86::Mem Compiler::getFprPtr(size_t index, uint32_t size, uint32_t disp) const
+{
+    auto offset = interpreter::Executor::getOffsetToFprf() + FPR_file::getOffsetToStartOfRegisters();
+    return asmjit::x86::ptr(executor_p_, offset + sizeof(Register) * index + disp, size);
+}
+
+void Compiler::compileCanonicalNaN(asmjit::x86::Compiler &compiler, asmjit::x86::Xmm dst, bool is_double)
+{
+    auto bits = compiler.newGpq();
+    if (is_double) {
+        compiler.mov(bits, FPR_file::CANONICAL_NAN_D);
+        compiler.movq(dst, bits);
+    } else {
+        compiler.mov(bits.r32(), FPR_file::CANONICAL_NAN_S);
+        compiler.movd(dst, bits.r32());
+    }
+}
+
+asmjit::x86::Xmm Compiler::compileLoadFloat(asmjit::x86::Compiler &compiler, size_t index, bool is_double)
+{
+    auto value = compiler.newXmm();
+    if (is_double) {
+        compiler.movsd(value, getFprPtr(index, sizeof(uint64_t)));
+        return value;
+    }
+    auto done = compiler.newLabel();
+    compiler.movss(value, getFprPtr(index, sizeof(uint32_t)));
+    compiler.cmp(getFprPtr(index, sizeof(uint32_t), sizeof(uint32_t)), -1);
+    compiler.je(done);
+    compileCanonicalNaN(compiler, value, false);
+    compiler.bind(done);
+    return value;
+}
+
+void Compiler::compileStoreFloat(asmjit::x86::Compiler &compiler, size_t index, asmjit::x86::Xmm value,
+                                 bool is_double)
+{
+    // Only NaNs compare unordered with themselves
+    auto done = compiler.newLabel();
+    if (is_double) {
+        compiler.ucomisd(value, value);
+    } else {
+        compiler.ucomiss(value, value);
+    }
+    compiler.jnp(done);
+    compileCanonicalNaN(compiler, value, is_double);
+    compiler.bind(done);
+
+    if (is_double) {
+        compiler.movsd(getFprPtr(index, sizeof(uint64_t)), value);
+    } else {
+        compiler.movss(getFprPtr(index, sizeof(uint32_t)), value);
+        compiler.mov(getFprPtr(index, sizeof(uint32_t), sizeof(uint32_t)), -1);
+    }
+}
+
+void Compiler::compileFloatArith(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double)
+{
+    auto op1 = compileLoadFloat(compiler, instr->rs1, is_double);
+    switch (instr->inst_id) {
+        case InstructionId::FSQRT_S:
+            compiler.sqrtss(op1, op1);
+            break;
+        case InstructionId::FSQRT_D:
+            compiler.sqrtsd(op1, op1);
+            break;
+        default: {
+            auto op2 = compileLoadFloat(compiler, instr->rs2, is_double);
+            switch (instr->inst_id) {
+                case InstructionId::FADD_S:
+                    compiler.addss(op1, op2);
+                    break;
+                case InstructionId::FADD_D:
+                    compiler.addsd(op1, op2);
+                    break;
+                case InstructionId::FSUB_S:
+                    compiler.subss(op1, op2);
+                    break;
+                case InstructionId::FSUB_D:
+                    compiler.subsd(op1, op2);
+                    break;
+                case InstructionId::FMUL_S:
+                    compiler.mulss(op1, op2);
+                    break;
+                case InstructionId::FMUL_D:
+                    compiler.mulsd(op1, op2);
+                    break;
+                case InstructionId::FDIV_S:
+                    compiler.divss(op1, op2);
+                    break;
+                default:
+                    compiler.divsd(op1, op2);
+                    break;
+            }
+        }
+    }
+    compileStoreFloat(compiler, instr->rd, op1, is_double);
+}
+
+void Compiler::compileFloatFused(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double)
+{
+    // 213 forms compute op1 = op1 * op2 +- op3 with a single rounding. RISC-V FNMSUB negates the product only,
+    // which is x86 FNMADD, and FNMADD negates the whole result, which is x86 FNMSUB
+    auto op1 = compileLoadFloat(compiler, instr->rs1, is_double);
+    auto op2 = compileLoadFloat(compiler, instr->rs2, is_double);
+    auto op3 = compileLoadFloat(compiler, instr->rs3, is_double);
+    switch (instr->inst_id) {
+        case InstructionId::FMADD_S:
+            compiler.vfmadd213ss(op1, op2, op3);
+            break;
+        case InstructionId::FMADD_D:
+            compiler.vfmadd213sd(op1, op2, op3);
+            break;
+        case InstructionId::FMSUB_S:
+            compiler.vfmsub213ss(op1, op2, op3);
+            break;
+        case InstructionId::FMSUB_D:
+            compiler.vfmsub213sd(op1, op2, op3);
+            break;
+        case InstructionId::FNMSUB_S:
+            compiler.vfnmadd213ss(op1, op2, op3);
+            break;
+        case InstructionId::FNMSUB_D:
+            compiler.vfnmadd213sd(op1, op2, op3);
+            break;
+        case InstructionId::FNMADD_S:
+            compiler.vfnmsub213ss(op1, op2, op3);
+            break;
+        default:
+            compiler.vfnmsub213sd(op1, op2, op3);
+            break;
+    }
+    compileStoreFloat(compiler, instr->rd, op1, is_double);
+}
+
+void Compiler::compileFloatLoad(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double)
+{
+    // Loads move raw bits, so NaN payloads survive
+    auto host = compileTranslate(compiler, instr);
+    auto value = compiler.newGpq();
+    if (is_double) {
+        compiler.mov(value, asmjit::x86::qword_ptr(host));
+        compiler.mov(getFprPtr(instr->rd, sizeof(uint64_t)), value);
+    } else {
+        compiler.mov(value.r32(), asmjit::x86::dword_ptr(host));
+        compiler.mov(getFprPtr(instr->rd, sizeof(uint32_t)), value.r32());
+        compiler.mov(getFprPtr(instr->rd, sizeof(uint32_t), sizeof(uint32_t)), -1);
+    }
+}
+
+void Compiler::compileFloatStore(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double)
+{
+    auto host = compileTranslate(compiler, instr, true);
+    auto value = compiler.newGpq();
+    if (is_double) {
+        compiler.mov(value, getFprPtr(instr->rs2, sizeof(uint64_t)));
+        compiler.mov(asmjit::x86::qword_ptr(host), value);
+    } else {
+        compiler.mov(value.r32(), getFprPtr(instr->rs2, sizeof(uint32_t)));
+        compiler.mov(asmjit::x86::dword_ptr(host), value.r32());
+    }
 }
 
 void Compiler::compileInstr(asmjit::x86::Compiler &compiler, const Instruction *instr, size_t instr_offset)
@@ -396,13 +1232,13 @@ void Compiler::compileInstr(asmjit::x86::Compiler &compiler, const Instruction *
             compileLUI(compiler, instr);
             return;
         case InstructionId::AUIPC:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileAUIPC(compiler, instr);
             return;
         case InstructionId::JAL:
             compileJAL(compiler, instr);
             return;
         case InstructionId::JALR:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileJALR(compiler, instr);
             return;
         case InstructionId::BEQ:
             compileBEQ(compiler, instr);
@@ -423,37 +1259,37 @@ void Compiler::compileInstr(asmjit::x86::Compiler &compiler, const Instruction *
             compileBGEU(compiler, instr);
             return;
         case InstructionId::LB:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileLB(compiler, instr);
             return;
         case InstructionId::LH:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileLH(compiler, instr);
             return;
         case InstructionId::LW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileLW(compiler, instr);
             return;
         case InstructionId::LD:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileLD(compiler, instr);
             return;
         case InstructionId::LBU:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileLBU(compiler, instr);
             return;
         case InstructionId::LHU:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileLHU(compiler, instr);
             return;
         case InstructionId::LWU:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileLWU(compiler, instr);
             return;
         case InstructionId::SB:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSB(compiler, instr);
             return;
         case InstructionId::SH:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSH(compiler, instr);
             return;
         case InstructionId::SW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSW(compiler, instr);
             return;
         case InstructionId::SD:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSD(compiler, instr);
             return;
         case InstructionId::ADDI:
             compileADDI(compiler, instr);
@@ -486,13 +1322,13 @@ void Compiler::compileInstr(asmjit::x86::Compiler &compiler, const Instruction *
             compileADDIW(compiler, instr);
             return;
         case InstructionId::SLLIW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSLLIW(compiler, instr);
             return;
         case InstructionId::SRLIW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSRLIW(compiler, instr);
             return;
         case InstructionId::SRAIW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSRAIW(compiler, instr);
             return;
         case InstructionId::ADD:
             compileADD(compiler, instr);
@@ -525,26 +1361,108 @@ void Compiler::compileInstr(asmjit::x86::Compiler &compiler, const Instruction *
             compileSRA(compiler, instr);
             return;
         case InstructionId::ADDW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileADDW(compiler, instr);
             return;
         case InstructionId::SUBW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSUBW(compiler, instr);
             return;
         case InstructionId::SLLW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSLLW(compiler, instr);
             return;
         case InstructionId::SRLW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSRLW(compiler, instr);
             return;
         case InstructionId::SRAW:
-            compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
+            compileSRAW(compiler, instr);
+            return;
+        case InstructionId::MUL:
+            compileMUL(compiler, instr);
+            return;
+        case InstructionId::MULH:
+            compileMULH(compiler, instr);
+            return;
+        case InstructionId::MULHSU:
+            compileMULHSU(compiler, instr);
+            return;
+        case InstructionId::MULHU:
+            compileMULHU(compiler, instr);
+            return;
+        case InstructionId::DIV:
+            compileDIV(compiler, instr);
+            return;
+        case InstructionId::DIVU:
+            compileDIVU(compiler, instr);
+            return;
+        case InstructionId::REM:
+            compileREM(compiler, instr);
+            return;
+        case InstructionId::REMU:
+            compileREMU(compiler, instr);
+            return;
+        case InstructionId::MULW:
+            compileMULW(compiler, instr);
+            return;
+        case InstructionId::DIVW:
+            compileDIVW(compiler, instr);
+            return;
+        case InstructionId::DIVUW:
+            compileDIVUW(compiler, instr);
+            return;
+        case InstructionId::REMW:
+            compileREMW(compiler, instr);
+            return;
+        case InstructionId::REMUW:
+            compileREMUW(compiler, instr);
             return;
         case InstructionId::ECALL:
+        case InstructionId::FENCE_I:
             compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
             return;
+        case InstructionId::FADD_S:
+        case InstructionId::FSUB_S:
+        case InstructionId::FMUL_S:
+        case InstructionId::FDIV_S:
+        case InstructionId::FSQRT_S:
+        case InstructionId::FADD_D:
+        case InstructionId::FSUB_D:
+        case InstructionId::FMUL_D:
+        case InstructionId::FDIV_D:
+        case InstructionId::FSQRT_D:
+            if (instr->rm != FPR_file::DYN)
+                break;
+            compileFloatArith(compiler, instr, IsDoubleOp(instr->inst_id));
+            return;
+        case InstructionId::FMADD_S:
+        case InstructionId::FMSUB_S:
+        case InstructionId::FNMSUB_S:
+        case InstructionId::FNMADD_S:
+        case InstructionId::FMADD_D:
+        case InstructionId::FMSUB_D:
+        case InstructionId::FNMSUB_D:
+        case InstructionId::FNMADD_D:
+            if (instr->rm != FPR_file::DYN || !runtime_.cpuFeatures().x86().hasFMA())
+                break;
+            compileFloatFused(compiler, instr, IsDoubleOp(instr->inst_id));
+            return;
+        case InstructionId::FLW:
+            compileFloatLoad(compiler, instr, false);
+            return;
+        case InstructionId::FLD:
+            compileFloatLoad(compiler, instr, true);
+            return;
+        case InstructionId::FSW:
+            compileFloatStore(compiler, instr, false);
+            return;
+        case InstructionId::FSD:
+            compileFloatStore(compiler, instr, true);
+            return;
+        case InstructionId::FENCE:
+            return;
         default:
-            std::abort();
+            break;
     }
+    // Everything else, including static rounding modes, runs in the interpreter
+    compileInvoke(compiler, interpreter::runInstrIface, instr_offset);
 }
 
 }  // namespace simulator::compiler
@@ -2,26 +2,60 @@
 #define COMPILER_COMPILER_HPP
 
 #include <asmjit/asmjit.h>
+#include <array>
+#include <bitset>
+#include <optional>
+#include <utility>
 #include "interpreter/BB.h"
+#include "interpreter/gpr.h"
 #include "interpreter/instruction.h"
+#include "memory/includes/mmu.hpp"
 
 namespace simulator::compiler {
 
 class Compiler {
 public:
-    void run(interpreter::DecodedBB &decodedBB, bool is_cosim);
+    using InvokeEntry = void (*)(interpreter::Executor *, const Instruction *);
 
+    Compiler(mem::MMU *mmu, asmjit::JitRuntime &runtime, interpreter::ReturnStack *return_stack)
+        : mmu_(mmu), runtime_(runtime), return_stack_(return_stack) {};
+
+    // Compiles region.trace, entry and chain slots are stored into region
+    void run(interpreter::CompiledRegion &region, bool is_cosim);
+
+    // Cached guest register, must not be modified by the caller
+    asmjit::x86::Gp compileUseReg(asmjit::x86::Compiler &compiler, size_t index);
+    // Scratch copy of a guest register
     asmjit::x86::Gp compileGetReg(asmjit::x86::Compiler &compiler, size_t index);
     void compileSetReg(asmjit::x86::Compiler &compiler, size_t index, asmjit::x86::Gp reg);
-    void compileSetReg(asmjit::x86::Compiler &compiler, size_t index, Immediate_t imm);
-    asmjit::x86::Gp compileGetPC(asmjit::x86::Compiler &compiler);
-    void compileIncrementPC(asmjit::x86::Compiler &compiler);
-    void compileIncrementPC(asmjit::x86::Compiler &compiler, Immediate_t imm);
-    void compileSetPC(asmjit::x86::Compiler &compiler, Immediate_t imm);
+    void compileSetReg(asmjit::x86::Compiler &compiler, size_t index, Register imm);
+    void compileWriteBack(asmjit::x86::Compiler &compiler);
+    // PC is known at compile time, so it's stored only where it can be observed: exits and interpreter calls
+    void compileSetPC(asmjit::x86::Compiler &compiler, Register pc);
     void compileSetPC(asmjit::x86::Compiler &compiler, asmjit::x86::Gp pc);
+    void compileChainExit(asmjit::x86::Compiler &compiler, Register target_pc);
+    void compileBranchExits(asmjit::x86::Compiler &compiler, asmjit::Label not_taken, SRegister offset);
+    void compileIndirectExit(asmjit::x86::Compiler &compiler);
+    // Every exit accounts for the instructions retired on its path
+    void compileRetire(asmjit::x86::Compiler &compiler);
+    // Indirect jump exits check the inline cache of the site, returns check the top of the return stack
+    void compileCachedExit(asmjit::x86::Compiler &compiler, asmjit::x86::Gp target);
+    // Pops the predicted return, return_pc is pushed afterwards by coroutine switches
+    void compileReturnExit(asmjit::x86::Compiler &compiler, asmjit::x86::Gp target,
+                           std::optional<Register> return_pc = std::nullopt);
+    void compilePopReturn(asmjit::x86::Compiler &compiler);
+    void compilePushReturn(asmjit::x86::Compiler &compiler, Register return_pc);
+    // Stores go through the store TLB, which misses on pages holding code
+    asmjit::x86::Gp compileTranslate(asmjit::x86::Compiler &compiler, const Instruction *instr,
+                                     bool is_store = false);
+    // Returns quotient and remainder with RISC-V results for division by zero and overflow
+    std::pair<asmjit::x86::Gp, asmjit::x86::Gp> compileDivRem(asmjit::x86::Compiler &compiler,
+                                                              const Instruction *instr, bool is_signed,
+                                                              bool is_word);
 
     void compileADDI(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileLUI(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileAUIPC(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileBEQ(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileBNE(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileBLT(asmjit::x86::Compiler &compiler, const Instruction *instr);
@@ -30,6 +64,8 @@ public:
     void compileBGEU(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileJALR(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileJAL(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    // JALR whose base register is known, e.g. AUIPC + JALR calls
+    void compileJump(asmjit::x86::Compiler &compiler, const Instruction *instr, Register target);
     void compileSLLI(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileSLL(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileSLT(asmjit::x86::Compiler &compiler, const Instruction *instr);
@@ -49,17 +85,81 @@ public:
     void compileORI(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileANDI(asmjit::x86::Compiler &compiler, const Instruction *instr);
     void compileADDIW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSLLIW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSRLIW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSRAIW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileADDW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSUBW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSLLW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSRLW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSRAW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileLB(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileLH(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileLW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileLD(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileLBU(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileLHU(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileLWU(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSB(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSH(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileSD(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileMUL(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileMULH(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileMULHSU(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileMULHU(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileDIV(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileDIVU(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileREM(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileREMU(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileMULW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileDIVW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileDIVUW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileREMW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+    void compileREMUW(asmjit::x86::Compiler &compiler, const Instruction *instr);
+
+    // FP registers aren't cached, every operation goes through the register file in Executor
+    asmjit::x86::Mem getFprPtr(size_t index, uint32_t size, uint32_t disp = 0) const;
+    // Single precision values which aren't NaN-boxed load as the canonical NaN
+    asmjit::x86::Xmm compileLoadFloat(asmjit::x86::Compiler &compiler, size_t index, bool is_double);
+    // NaN results are stored as the canonical NaN, single precision ones are NaN-boxed
+    void compileStoreFloat(asmjit::x86::Compiler &compiler, size_t index, asmjit::x86::Xmm value, bool is_double);
+    void compileCanonicalNaN(asmjit::x86::Compiler &compiler, asmjit::x86::Xmm dst, bool is_double);
+    // Exceptions accrue in MXCSR and the rounding comes from it, so only the dynamic rounding mode is compiled
+    void compileFloatArith(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double);
+    void compileFloatFused(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double);
+    void compileFloatLoad(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double);
+    void compileFloatStore(asmjit::x86::Compiler &compiler, const Instruction *instr, bool is_double);
 
     void compileInstr(asmjit::x86::Compiler &compiler_, const Instruction *instr, size_t instr_offset);
-    void compileInvoke(asmjit::x86::Compiler &compiler_, interpreter::DecodedBB::CompiledEntry executor,
-                       size_t instr_offset);
+    // Cosimulation: compiles instr and appends a record of the register it writes to the cosim trace
+    void compileTracedInstr(asmjit::x86::Compiler &compiler, const Instruction *instr, size_t instr_offset);
+    void compileTraceRecord(asmjit::x86::Compiler &compiler, uint8_t reg, asmjit::x86::Gp value);
+    void compileInvoke(asmjit::x86::Compiler &compiler_, InvokeEntry executor, size_t instr_offset);
 
 private:
-    asmjit::JitRuntime runtime_;
+    static constexpr size_t GUEST_REGS_NUM = 32;
+
+    void resetRegCache();
+
+    mem::MMU *mmu_;
+    asmjit::JitRuntime &runtime_;
+    interpreter::ReturnStack *return_stack_;
+    interpreter::CompiledRegion *region_ = nullptr;
+    // Guest PC of the instruction being compiled
+    Register instr_pc_ = 0;
+    // Guest PC of the next instruction in the trace, none at the end of it
+    std::optional<Register> next_pc_;
+    // Trace instructions retired by an exit taken at the instruction being compiled
+    size_t retired_ = 0;
     asmjit::x86::Gp executor_p_;
     asmjit::x86::Gp pc_p_;
     asmjit::x86::Gp registers_p_;
     asmjit::x86::Gp instruction_p_;
+    // Guest registers live in virtual registers until the block exits or calls the interpreter
+    std::array<asmjit::x86::Gp, GUEST_REGS_NUM> guest_regs_;
+    std::bitset<GUEST_REGS_NUM> loaded_regs_;
+    std::bitset<GUEST_REGS_NUM> dirty_regs_;
 };
 
 }  // namespace simulator::compiler
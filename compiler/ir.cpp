@@ -0,0 +1,400 @@
+#include "compiler/ir.hpp"
+
+#include <array>
+#include <bitset>
+#include <limits>
+#include <optional>
+#include <utility>
+#include "bitops.h"
+#include "generated/instructions_enum_gen.h"
+
+namespace simulator::compiler {
+
+namespace {
+
+constexpr size_t GUEST_REGS_NUM = 32;
+
+struct Effects {
+    bool reads_rs1 = false;
+    bool reads_rs2 = false;
+    bool writes_rd = false;
+    // Has no effect besides writing rd, so it can be removed once rd is dead
+    bool is_pure = false;
+    bool is_memory = false;
+    // Guest registers may be observed after it by the dispatcher
+    bool is_exit = false;
+    // Runs in the interpreter and may change any register
+    bool is_barrier = false;
+};
+
+}  // namespace
+
+static Effects GetEffects(InstructionId inst_id)
+{
+    switch (inst_id) {
+        case InstructionId::LUI:
+        case InstructionId::AUIPC:
+            return {.writes_rd = true, .is_pure = true};
+        case InstructionId::ADDI:
+        case InstructionId::SLTI:
+        case InstructionId::SLTIU:
+        case InstructionId::XORI:
+        case InstructionId::ORI:
+        case InstructionId::ANDI:
+        case InstructionId::SLLI:
+        case InstructionId::SRLI:
+        case InstructionId::SRAI:
+        case InstructionId::ADDIW:
+        case InstructionId::SLLIW:
+        case InstructionId::SRLIW:
+        case InstructionId::SRAIW:
+            return {.reads_rs1 = true, .writes_rd = true, .is_pure = true};
+        case InstructionId::ADD:
+        case InstructionId::SUB:
+        case InstructionId::SLL:
+        case InstructionId::SLT:
+        case InstructionId::SLTU:
+        case InstructionId::XOR:
+        case InstructionId::SRL:
+        case InstructionId::SRA:
+        case InstructionId::OR:
+        case InstructionId::AND:
+        case InstructionId::ADDW:
+        case InstructionId::SUBW:
+        case InstructionId::SLLW:
+        case InstructionId::SRLW:
+        case InstructionId::SRAW:
+        case InstructionId::MUL:
+        case InstructionId::MULH:
+        case InstructionId::MULHSU:
+        case InstructionId::MULHU:
+        case InstructionId::DIV:
+        case InstructionId::DIVU:
+        case InstructionId::REM:
+        case InstructionId::REMU:
+        case InstructionId::MULW:
+        case InstructionId::DIVW:
+        case InstructionId::DIVUW:
+        case InstructionId::REMW:
+        case InstructionId::REMUW:
+            return {.reads_rs1 = true, .reads_rs2 = true, .writes_rd = true, .is_pure = true};
+        case InstructionId::LB:
+        case InstructionId::LH:
+        case InstructionId::LW:
+        case InstructionId::LD:
+        case InstructionId::LBU:
+        case InstructionId::LHU:
+        case InstructionId::LWU:
+            // Loads stay even if rd is dead, a bad address has to fault
+            return {.reads_rs1 = true, .writes_rd = true, .is_memory = true};
+        case InstructionId::SB:
+        case InstructionId::SH:
+        case InstructionId::SW:
+        case InstructionId::SD:
+            return {.reads_rs1 = true, .reads_rs2 = true, .is_memory = true};
+        case InstructionId::BEQ:
+        case InstructionId::BNE:
+        case InstructionId::BLT:
+        case InstructionId::BGE:
+        case InstructionId::BLTU:
+        case InstructionId::BGEU:
+            return {.reads_rs1 = true, .reads_rs2 = true, .is_exit = true};
+        case InstructionId::JAL:
+            return {.writes_rd = true, .is_exit = true};
+        case InstructionId::JALR:
+            return {.reads_rs1 = true, .writes_rd = true, .is_exit = true};
+        case InstructionId::FLW:
+        case InstructionId::FLD:
+        case InstructionId::FSW:
+        case InstructionId::FSD:
+            // Data register is an FP one
+            return {.reads_rs1 = true, .is_memory = true};
+        // FP arithmetic touches FP registers only, even when it falls back to the interpreter
+        case InstructionId::FADD_S:
+        case InstructionId::FSUB_S:
+        case InstructionId::FMUL_S:
+        case InstructionId::FDIV_S:
+        case InstructionId::FSQRT_S:
+        case InstructionId::FMADD_S:
+        case InstructionId::FMSUB_S:
+        case InstructionId::FNMSUB_S:
+        case InstructionId::FNMADD_S:
+        case InstructionId::FADD_D:
+        case InstructionId::FSUB_D:
+        case InstructionId::FMUL_D:
+        case InstructionId::FDIV_D:
+        case InstructionId::FSQRT_D:
+        case InstructionId::FMADD_D:
+        case InstructionId::FMSUB_D:
+        case InstructionId::FNMSUB_D:
+        case InstructionId::FNMADD_D:
+        case InstructionId::FENCE:
+            return {};
+        default:
+            return {.is_exit = true, .is_barrier = true};
+    }
+}
+
+// Same results as the native emitters, which follow the ISA for shift amounts and unsigned compares
+static std::optional<Register> Fold(const Instruction &instr, Register pc, Register op1, Register op2)
+{
+    Register imm = instr.imm;
+    auto shamt = instr.imm;
+    switch (instr.inst_id) {
+        case InstructionId::LUI:
+            return imm;
+        case InstructionId::AUIPC:
+            return pc + imm;
+        case InstructionId::ADDI:
+            return op1 + imm;
+        case InstructionId::SLTI:
+            return GetSignedForm(op1) < GetSignedForm(imm) ? 1 : 0;
+        case InstructionId::SLTIU:
+            return op1 < imm ? 1 : 0;
+        case InstructionId::XORI:
+            return op1 ^ imm;
+        case InstructionId::ORI:
+            return op1 | imm;
+        case InstructionId::ANDI:
+            return op1 & imm;
+        case InstructionId::SLLI:
+            return op1 << shamt;
+        case InstructionId::SRLI:
+            return op1 >> shamt;
+        case InstructionId::SRAI:
+            return GetUnsignedForm(GetSignedForm(op1) >> shamt);
+        case InstructionId::ADDIW:
+            return GetSignedExtension<Register, 32>(op1 + imm);
+        case InstructionId::SLLIW:
+            return GetSignedExtension<Register, 32>(op1 << (shamt & 0x1f));
+        case InstructionId::SRLIW:
+            return GetSignedExtension<Register, 32>(static_cast<uint32_t>(op1) >> (shamt & 0x1f));
+        case InstructionId::SRAIW:
+            return GetSignedExtension<Register, 32>(static_cast<uint32_t>(static_cast<int32_t>(op1) >> (shamt & 0x1f)));
+        case InstructionId::ADD:
+            return op1 + op2;
+        case InstructionId::SUB:
+            return op1 - op2;
+        case InstructionId::SLL:
+            return op1 << (op2 & 0x3f);
+        case InstructionId::SLT:
+            return GetSignedForm(op1) < GetSignedForm(op2) ? 1 : 0;
+        case InstructionId::SLTU:
+            return op1 < op2 ? 1 : 0;
+        case InstructionId::XOR:
+            return op1 ^ op2;
+        case InstructionId::SRL:
+            return op1 >> (op2 & 0x3f);
+        case InstructionId::SRA:
+            return GetUnsignedForm(GetSignedForm(op1) >> (op2 & 0x3f));
+        case InstructionId::OR:
+            return op1 | op2;
+        case InstructionId::AND:
+            return op1 & op2;
+        case InstructionId::ADDW:
+            return GetSignedExtension<Register, 32>(op1 + op2);
+        case InstructionId::SUBW:
+            return GetSignedExtension<Register, 32>(op1 - op2);
+        case InstructionId::SLLW:
+            return GetSignedExtension<Register, 32>(op1 << (op2 & 0x1f));
+        case InstructionId::SRLW:
+            return GetSignedExtension<Register, 32>(static_cast<uint32_t>(op1) >> (op2 & 0x1f));
+        case InstructionId::SRAW:
+            return GetSignedExtension<Register, 32>(static_cast<uint32_t>(static_cast<int32_t>(op1) >> (op2 & 0x1f)));
+        case InstructionId::MUL:
+            return op1 * op2;
+        case InstructionId::MULW:
+            return GetSignedExtension<Register, 32>(op1 * op2);
+        default:
+            return std::nullopt;
+    }
+}
+
+std::vector<IrInst> Optimizer::run(const interpreter::Trace &trace)
+{
+    auto ir = build(trace);
+    propagateConstants(ir, trace);
+    fuseCompareBranches(ir);
+    propagateCopies(ir);
+    eliminateDeadStores(ir);
+    return ir;
+}
+
+std::vector<IrInst> Optimizer::build(const interpreter::Trace &trace)
+{
+    std::vector<IrInst> ir;
+    ir.reserve(trace.instrs.size());
+    for (size_t i = 0; i < trace.instrs.size(); ++i)
+        ir.push_back({IrInst::Kind::GUEST, trace.instrs[i], i, 0});
+    return ir;
+}
+
+void Optimizer::propagateConstants(std::vector<IrInst> &ir, const interpreter::Trace &trace)
+{
+    std::array<std::optional<Register>, GUEST_REGS_NUM> known;
+    for (auto &inst : ir) {
+        known[GPR_file::X0] = 0;
+        if (inst.kind != IrInst::Kind::GUEST)
+            continue;
+        auto &instr = inst.instr;
+        auto effects = GetEffects(instr.inst_id);
+        if (effects.is_barrier) {
+            known.fill(std::nullopt);
+            continue;
+        }
+        if (!effects.writes_rd)
+            continue;
+
+        auto pc = trace.pcs[inst.index];
+        std::optional<Register> value;
+        if (effects.is_pure) {
+            auto op1 = effects.reads_rs1 ? known[instr.rs1] : std::optional<Register>(0);
+            auto op2 = effects.reads_rs2 ? known[instr.rs2] : std::optional<Register>(0);
+            if (op1 && op2)
+                value = Fold(instr, pc, *op1, *op2);
+            if (value) {
+                inst.kind = IrInst::Kind::CONST;
+                inst.value = *value;
+            }
+        } else if (instr.inst_id == InstructionId::JAL || instr.inst_id == InstructionId::JALR) {
+            // LUI/AUIPC + JALR pairs jump to a known target, so the exit can be chained like a JAL
+            if (instr.inst_id == InstructionId::JALR && known[instr.rs1]) {
+                inst.kind = IrInst::Kind::JUMP;
+                inst.value = (*known[instr.rs1] + instr.imm) & ~1ULL;
+            }
+            // Link value is known, but the jump itself still has to be emitted
+            value = pc + sizeof(uint32_t);
+        }
+        known[instr.rd] = value;
+    }
+}
+
+void Optimizer::fuseCompareBranches(std::vector<IrInst> &ir)
+{
+    for (size_t i = 0; i + 1 < ir.size(); ++i) {
+        const auto &cmp = ir[i].instr;
+        auto &branch = ir[i + 1].instr;
+        if (ir[i].kind != IrInst::Kind::GUEST || ir[i + 1].kind != IrInst::Kind::GUEST)
+            continue;
+        if (cmp.inst_id != InstructionId::SLT && cmp.inst_id != InstructionId::SLTU)
+            continue;
+        if (branch.inst_id != InstructionId::BNE && branch.inst_id != InstructionId::BEQ)
+            continue;
+        // The compared registers must still hold their values at the branch
+        if (cmp.rd == GPR_file::X0 || cmp.rd == cmp.rs1 || cmp.rd == cmp.rs2)
+            continue;
+        bool tests_result = (branch.rs1 == cmp.rd && branch.rs2 == GPR_file::X0) ||
+                            (branch.rs1 == GPR_file::X0 && branch.rs2 == cmp.rd);
+        if (!tests_result)
+            continue;
+
+        // The result is still written for side exits, but the branch no longer waits for it
+        bool is_signed = cmp.inst_id == InstructionId::SLT;
+        if (branch.inst_id == InstructionId::BNE) {
+            branch.inst_id = is_signed ? InstructionId::BLT : InstructionId::BLTU;
+        } else {
+            branch.inst_id = is_signed ? InstructionId::BGE : InstructionId::BGEU;
+        }
+        branch.rs1 = cmp.rs1;
+        branch.rs2 = cmp.rs2;
+    }
+}
+
+void Optimizer::propagateCopies(std::vector<IrInst> &ir)
+{
+    // copy_of[r]: register holding the same value as r, base_of[r]: register and offset r was computed from
+    std::array<std::optional<Register_t>, GUEST_REGS_NUM> copy_of;
+    std::array<std::optional<std::pair<Register_t, SRegister>>, GUEST_REGS_NUM> base_of;
+
+    auto kill = [&copy_of, &base_of](Register_t reg) {
+        copy_of[reg].reset();
+        base_of[reg].reset();
+        for (size_t i = 0; i < GUEST_REGS_NUM; ++i) {
+            if (copy_of[i] == reg)
+                copy_of[i].reset();
+            if (base_of[i] && base_of[i]->first == reg)
+                base_of[i].reset();
+        }
+    };
+
+    for (auto &inst : ir) {
+        auto &instr = inst.instr;
+        if (inst.kind == IrInst::Kind::NOP)
+            continue;
+        if (inst.kind == IrInst::Kind::CONST) {
+            kill(instr.rd);
+            continue;
+        }
+        auto effects = GetEffects(instr.inst_id);
+        if (effects.is_barrier) {
+            copy_of.fill(std::nullopt);
+            base_of.fill(std::nullopt);
+            continue;
+        }
+
+        if (effects.reads_rs1 && copy_of[instr.rs1])
+            instr.rs1 = *copy_of[instr.rs1];
+        if (effects.reads_rs2 && copy_of[instr.rs2])
+            instr.rs2 = *copy_of[instr.rs2];
+        if (effects.is_memory && base_of[instr.rs1]) {
+            auto [base, offset] = *base_of[instr.rs1];
+            // Displacement of the folded address has to fit into x86 addressing
+            auto disp = offset + instr.imm;
+            if (disp >= std::numeric_limits<int32_t>::min() && disp <= std::numeric_limits<int32_t>::max()) {
+                instr.rs1 = base;
+                instr.imm = disp;
+            }
+        }
+
+        if (!effects.writes_rd)
+            continue;
+        kill(instr.rd);
+        if (instr.inst_id == InstructionId::ADDI && instr.rd != GPR_file::X0 && instr.rs1 != GPR_file::X0 &&
+            instr.rs1 != instr.rd) {
+            auto offset = instr.imm;
+            if (offset == 0) {
+                copy_of[instr.rd] = instr.rs1;
+            } else {
+                base_of[instr.rd] = std::make_pair(instr.rs1, offset);
+            }
+        }
+    }
+}
+
+void Optimizer::eliminateDeadStores(std::vector<IrInst> &ir)
+{
+    // The dispatcher and the interpreter see the whole register file, so everything is live at those points
+    std::bitset<GUEST_REGS_NUM> live;
+    live.set();
+    for (auto it = ir.rbegin(); it != ir.rend(); ++it) {
+        auto &instr = it->instr;
+        if (it->kind == IrInst::Kind::NOP)
+            continue;
+        if (it->kind == IrInst::Kind::CONST) {
+            if (instr.rd == GPR_file::X0 || !live.test(instr.rd)) {
+                it->kind = IrInst::Kind::NOP;
+            } else {
+                live.reset(instr.rd);
+            }
+            continue;
+        }
+
+        auto effects = GetEffects(instr.inst_id);
+        if (effects.is_pure && (instr.rd == GPR_file::X0 || !live.test(instr.rd))) {
+            it->kind = IrInst::Kind::NOP;
+            continue;
+        }
+        // Jumps exit after writing the link register
+        if (effects.is_exit)
+            live.set();
+        if (effects.writes_rd)
+            live.reset(instr.rd);
+        // Base register of a jump with a known target isn't read by the emitted code
+        if (effects.reads_rs1 && it->kind != IrInst::Kind::JUMP)
+            live.set(instr.rs1);
+        if (effects.reads_rs2)
+            live.set(instr.rs2);
+    }
+}
+
+}  // namespace simulator::compiler
@@ -0,0 +1,51 @@
+#ifndef COMPILER_IR_HPP
+#define COMPILER_IR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "interpreter/BB.h"
+#include "interpreter/gpr.h"
+#include "interpreter/instruction.h"
+
+namespace simulator::compiler {
+
+struct IrInst {
+    enum class Kind : uint8_t {
+        // Lowered by the instruction emitters
+        GUEST,
+        // instr.rd gets a value known at compile time
+        CONST,
+        // JALR to a target known at compile time, which is kept in value
+        JUMP,
+        // Removed by the optimizer
+        NOP,
+    };
+
+    Kind kind = Kind::GUEST;
+    // Copy of the trace instruction, operands may be rewritten by the passes
+    Instruction instr;
+    // Position in the trace, interpreter calls get the original instruction
+    size_t index = 0;
+    Register value = 0;
+};
+
+// Block-local optimizer over a trace. Guest registers are the IR values: a trace is straight-line code,
+// so tracking the last definition of every register gives the same facts as SSA renaming would
+class Optimizer {
+public:
+    static std::vector<IrInst> run(const interpreter::Trace &trace);
+
+    static std::vector<IrInst> build(const interpreter::Trace &trace);
+    static void propagateConstants(std::vector<IrInst> &ir, const interpreter::Trace &trace);
+    // SLT/SLTU followed by a test of their result against zero branch on the compared registers directly
+    static void fuseCompareBranches(std::vector<IrInst> &ir);
+    // Rewrites uses of register copies and folds base + offset chains into load and store displacements
+    static void propagateCopies(std::vector<IrInst> &ir);
+    // Removes pure instructions whose result is overwritten before any exit can observe it, x0 writes included
+    static void eliminateDeadStores(std::vector<IrInst> &ir);
+};
+
+}  // namespace simulator::compiler
+
+#endif  // COMPILER_IR_HPP
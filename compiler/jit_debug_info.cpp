@@ -0,0 +1,169 @@
+#include "compiler/jit_debug_info.hpp"
+
+#include <elf.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// Names and layout are fixed by GDB, which breaks on the function and reads the descriptor when it's hit
+extern "C" {
+enum JitActions : uint32_t { JIT_NOACTION = 0, JIT_REGISTER_FN, JIT_UNREGISTER_FN };
+
+struct jit_code_entry {
+    jit_code_entry *next_entry;
+    jit_code_entry *prev_entry;
+    const char *symfile_addr;
+    uint64_t symfile_size;
+};
+
+struct jit_descriptor {
+    uint32_t version;
+    uint32_t action_flag;
+    jit_code_entry *relevant_entry;
+    jit_code_entry *first_entry;
+};
+
+[[gnu::noinline, gnu::used]] void __jit_debug_register_code()
+{
+    asm volatile("" ::: "memory");
+}
+
+[[gnu::used]] jit_descriptor __jit_debug_descriptor = {1, JIT_NOACTION, nullptr, nullptr};
+}
+
+namespace simulator::compiler {
+
+struct JitDebugInfo::GdbEntry {
+    jit_code_entry entry {};
+    std::vector<char> image;
+};
+
+// Relocatable object with a single function symbol. .text takes no space in the file, its address
+// already points at the compiled code
+static std::vector<char> MakeSymbolFile(const void *code, size_t size, const std::string &name)
+{
+    static constexpr char SHSTRTAB[] = "\0.text\0.symtab\0.strtab\0.shstrtab";
+    enum Section { NONE, TEXT, SYMTAB, STRTAB, SHSTRTAB_SECTION, SECTION_NUM };
+
+    size_t shstrtab_off = sizeof(Elf64_Ehdr);
+    size_t strtab_off = shstrtab_off + sizeof(SHSTRTAB);
+    size_t strtab_size = name.size() + 2;
+    size_t symtab_off = (strtab_off + strtab_size + 7) & ~size_t(7);
+    size_t shdr_off = symtab_off + 2 * sizeof(Elf64_Sym);
+    std::vector<char> image(shdr_off + SECTION_NUM * sizeof(Elf64_Shdr));
+
+    Elf64_Ehdr ehdr {};
+    std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_type = ET_REL;
+    ehdr.e_machine = EM_X86_64;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_shoff = shdr_off;
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = SECTION_NUM;
+    ehdr.e_shstrndx = SHSTRTAB_SECTION;
+    std::memcpy(image.data(), &ehdr, sizeof(ehdr));
+    std::memcpy(image.data() + shstrtab_off, SHSTRTAB, sizeof(SHSTRTAB));
+    // First byte of a string table is the empty name
+    std::memcpy(image.data() + strtab_off + 1, name.c_str(), name.size() + 1);
+
+    Elf64_Sym syms[2] {};
+    syms[1].st_name = 1;
+    syms[1].st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+    syms[1].st_shndx = TEXT;
+    syms[1].st_value = reinterpret_cast<uintptr_t>(code);
+    syms[1].st_size = size;
+    std::memcpy(image.data() + symtab_off, syms, sizeof(syms));
+
+    Elf64_Shdr shdrs[SECTION_NUM] {};
+    shdrs[TEXT] = {1, SHT_NOBITS, SHF_ALLOC | SHF_EXECINSTR, reinterpret_cast<uintptr_t>(code), 0, size, 0, 0, 16, 0};
+    shdrs[SYMTAB] = {7, SHT_SYMTAB, 0, 0, symtab_off, sizeof(syms), STRTAB, 1, 8, sizeof(Elf64_Sym)};
+    shdrs[STRTAB] = {15, SHT_STRTAB, 0, 0, strtab_off, strtab_size, 0, 0, 1, 0};
+    shdrs[SHSTRTAB_SECTION] = {23, SHT_STRTAB, 0, 0, shstrtab_off, sizeof(SHSTRTAB), 0, 0, 1, 0};
+    std::memcpy(image.data() + shdr_off, shdrs, sizeof(shdrs));
+    return image;
+}
+
+JitDebugInfo::JitDebugInfo(const mem::MMU *mmu) : mmu_(mmu) {}
+
+JitDebugInfo::~JitDebugInfo()
+{
+    while (!gdb_entries_.empty())
+        removeCode(gdb_entries_.begin()->first);
+}
+
+void JitDebugInfo::enablePerfMap()
+{
+    std::ostringstream name;
+    name << "/tmp/perf-" << getpid() << ".map";
+    perf_map_.open(name.str(), std::ios::trunc);
+    if (!perf_map_)
+        std::cerr << "Unable to write perf map " << name.str() << std::endl;
+}
+
+void JitDebugInfo::enableGdb()
+{
+    is_gdb_ = true;
+}
+
+void JitDebugInfo::addCode(const void *code, size_t size, Register pc, const char *tier)
+{
+    auto name = getName(pc, tier);
+    // perf takes the last entry for an address, so reused code memory gets the new name
+    if (perf_map_.is_open())
+        perf_map_ << std::hex << reinterpret_cast<uintptr_t>(code) << " " << size << " " << name << std::endl;
+    if (!is_gdb_)
+        return;
+
+    auto gdb_entry = std::make_unique<GdbEntry>();
+    gdb_entry->image = MakeSymbolFile(code, size, name);
+    auto &entry = gdb_entry->entry;
+    entry.symfile_addr = gdb_entry->image.data();
+    entry.symfile_size = gdb_entry->image.size();
+    entry.next_entry = __jit_debug_descriptor.first_entry;
+    if (entry.next_entry != nullptr)
+        entry.next_entry->prev_entry = &entry;
+    __jit_debug_descriptor.first_entry = &entry;
+    __jit_debug_descriptor.relevant_entry = &entry;
+    __jit_debug_descriptor.action_flag = JIT_REGISTER_FN;
+    __jit_debug_register_code();
+    gdb_entries_[code] = std::move(gdb_entry);
+}
+
+void JitDebugInfo::removeCode(const void *code)
+{
+    auto it = gdb_entries_.find(code);
+    if (it == gdb_entries_.end())
+        return;
+
+    auto &entry = it->second->entry;
+    if (entry.prev_entry != nullptr)
+        entry.prev_entry->next_entry = entry.next_entry;
+    else
+        __jit_debug_descriptor.first_entry = entry.next_entry;
+    if (entry.next_entry != nullptr)
+        entry.next_entry->prev_entry = entry.prev_entry;
+    __jit_debug_descriptor.relevant_entry = &entry;
+    __jit_debug_descriptor.action_flag = JIT_UNREGISTER_FN;
+    __jit_debug_register_code();
+    gdb_entries_.erase(it);
+}
+
+std::string JitDebugInfo::getName(Register pc, const char *tier) const
+{
+    std::ostringstream name;
+    name << "rv:";
+    if (auto *sym = mmu_->FindFunctionSymbol(pc); sym != nullptr) {
+        name << sym->name;
+        if (pc != sym->addr)
+            name << "+0x" << std::hex << pc - sym->addr;
+    }
+    name << "@0x" << std::hex << pc << ":" << tier;
+    return name.str();
+}
+
+}  // namespace simulator::compiler
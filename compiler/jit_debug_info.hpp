@@ -0,0 +1,48 @@
+#ifndef COMPILER_JIT_DEBUG_INFO_HPP
+#define COMPILER_JIT_DEBUG_INFO_HPP
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "configs/macros.hpp"
+#include "interpreter/gpr.h"
+#include "memory/includes/mmu.hpp"
+
+namespace simulator::compiler {
+
+// Names compiled blocks for external tools: perf reads /tmp/perf-<pid>.map, GDB reads in-memory ELF objects
+// registered through its JIT interface. Both are fed by the hart thread only
+class JitDebugInfo final {
+public:
+    explicit JitDebugInfo(const mem::MMU *mmu);
+    ~JitDebugInfo();
+    NO_COPY_SEMANTIC(JitDebugInfo)
+    NO_MOVE_SEMANTIC(JitDebugInfo)
+
+    void enablePerfMap();
+    void enableGdb();
+    inline bool isEnabled() const
+    {
+        return perf_map_.is_open() || is_gdb_;
+    }
+    // tier is a short suffix which tells baseline and optimized code of the same block apart
+    void addCode(const void *code, size_t size, Register pc, const char *tier);
+    // Code is about to be released, GDB must not read its symbols anymore
+    void removeCode(const void *code);
+
+private:
+    struct GdbEntry;
+
+    std::string getName(Register pc, const char *tier) const;
+
+    const mem::MMU *mmu_;
+    std::ofstream perf_map_;
+    bool is_gdb_ = false;
+    std::unordered_map<const void *, std::unique_ptr<GdbEntry>> gdb_entries_;
+};
+
+}  // namespace simulator::compiler
+
+#endif
@@ -0,0 +1,88 @@
+#include "compiler/jit_stats.hpp"
+
+#include <utility>
+
+namespace simulator::compiler {
+
+static double Ratio(double part, double total)
+{
+    return total == 0 ? 0 : part / total;
+}
+
+static double ToMs(std::chrono::nanoseconds time)
+{
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+static void WriteTierJson(std::ostream &out, const char *name, const JitStats::Tier &tier)
+{
+    out << "    \"" << name << "\": {\n";
+    out << "      \"blocks\": " << tier.blocks << ",\n";
+    out << "      \"instrs\": " << tier.instrs << ",\n";
+    out << "      \"fallbacks\": " << tier.fallbacks << ",\n";
+    out << "      \"fallback_fraction\": " << Ratio(tier.fallbacks, tier.instrs) << ",\n";
+    out << "      \"code_bytes\": " << tier.code_bytes << ",\n";
+    out << "      \"compile_ms\": " << ToMs(tier.compile_time) << ",\n";
+    out << "      \"mean_compile_us\": " << Ratio(ToMs(tier.compile_time) * 1e3, tier.blocks) << ",\n";
+    out << "      \"max_compile_us\": " << ToMs(tier.max_compile_time) * 1e3 << "\n";
+    out << "    }";
+}
+
+void JitStats::writeJson(std::ostream &out) const
+{
+    auto lookups = dispatch.bb_cache_hits + dispatch.bb_cache_misses + dispatch.bb_cache_conflicts;
+    auto precision = out.precision(6);
+
+    out << "{\n";
+    out << "  \"jit\": {\n";
+    WriteTierJson(out, "baseline", baseline);
+    out << ",\n";
+    WriteTierJson(out, "optimized", optimized);
+    out << ",\n";
+    out << "    \"evicted_blocks\": " << evicted_blocks << ",\n";
+    out << "    \"live_code_bytes\": " << live_code_bytes << ",\n";
+    out << "    \"fallbacks_by_opcode\": {";
+    bool is_first = true;
+    for (size_t id = 0; id < fallbacks_by_opcode.size(); ++id) {
+        if (fallbacks_by_opcode[id] == 0)
+            continue;
+        out << (is_first ? "\n" : ",\n") << "      \"" << INSTRUCTION_NAMES[id] << "\": " << fallbacks_by_opcode[id];
+        is_first = false;
+    }
+    out << (is_first ? "}\n" : "\n    }\n");
+    out << "  },\n";
+    out << "  \"dispatch\": {\n";
+    out << "    \"bb_cache_hits\": " << dispatch.bb_cache_hits << ",\n";
+    out << "    \"bb_cache_misses\": " << dispatch.bb_cache_misses << ",\n";
+    out << "    \"bb_cache_conflicts\": " << dispatch.bb_cache_conflicts << ",\n";
+    out << "    \"bb_cache_hit_rate\": " << Ratio(dispatch.bb_cache_hits, lookups) << ",\n";
+    out << "    \"bb_cache_conflict_rate\": " << Ratio(dispatch.bb_cache_conflicts, lookups) << ",\n";
+    out << "    \"interpreted_instrs\": " << dispatch.interpreted_instrs << ",\n";
+    out << "    \"compiled_instrs\": " << dispatch.compiled_instrs << ",\n";
+    out << "    \"interpreter_ms\": " << ToMs(dispatch.interpreter_time) << ",\n";
+    out << "    \"compiled_ms\": " << ToMs(dispatch.compiled_time) << "\n";
+    out << "  }\n";
+    out << "}" << std::endl;
+    out.precision(precision);
+}
+
+void JitStats::writeText(std::ostream &out) const
+{
+    auto lookups = dispatch.bb_cache_hits + dispatch.bb_cache_misses + dispatch.bb_cache_conflicts;
+    for (auto [name, tier] : {std::pair {"Baseline", &baseline}, std::pair {"Optimized", &optimized}}) {
+        out << name << " blocks: " << tier->blocks << ", " << tier->code_bytes << " bytes, "
+            << ToMs(tier->compile_time) << " ms compiling, "
+            << Ratio(tier->fallbacks, tier->instrs) * 100 << "% of instructions interpreted" << std::endl;
+    }
+    out << "Evicted blocks: " << evicted_blocks << ", live code: " << live_code_bytes << " bytes" << std::endl;
+    out << "BB cache hit rate: " << Ratio(dispatch.bb_cache_hits, lookups) * 100
+        << "%, conflict rate: " << Ratio(dispatch.bb_cache_conflicts, lookups) * 100 << "%" << std::endl;
+    out << "Instructions interpreted: " << dispatch.interpreted_instrs << ", compiled: " << dispatch.compiled_instrs
+        << std::endl;
+    if (dispatch.interpreter_time.count() != 0 || dispatch.compiled_time.count() != 0) {
+        out << "Time interpreting: " << ToMs(dispatch.interpreter_time)
+            << " ms, in compiled code: " << ToMs(dispatch.compiled_time) << " ms" << std::endl;
+    }
+}
+
+}  // namespace simulator::compiler
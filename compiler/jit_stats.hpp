@@ -0,0 +1,51 @@
+#ifndef COMPILER_JIT_STATS_HPP
+#define COMPILER_JIT_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include "interpreter/instruction.h"
+
+namespace simulator::compiler {
+
+struct JitStats final {
+    struct Tier {
+        size_t blocks = 0;
+        size_t instrs = 0;
+        // Instructions compiled as calls into the interpreter
+        size_t fallbacks = 0;
+        size_t code_bytes = 0;
+        std::chrono::nanoseconds compile_time {};
+        std::chrono::nanoseconds max_compile_time {};
+    };
+
+    // Filled by the hart, times are only measured once the hart is asked to collect them
+    struct Dispatch {
+        size_t bb_cache_hits = 0;
+        // Empty slots
+        size_t bb_cache_misses = 0;
+        // Slots which held another block, it gets evicted
+        size_t bb_cache_conflicts = 0;
+        size_t interpreted_instrs = 0;
+        size_t compiled_instrs = 0;
+        std::chrono::nanoseconds interpreter_time {};
+        std::chrono::nanoseconds compiled_time {};
+    };
+
+    Tier baseline;
+    Tier optimized;
+    std::array<size_t, InstructionId::WRONG_INST + 1> fallbacks_by_opcode {};
+    // Blocks which lost their code to the cache limit, slot reuse or code writes
+    size_t evicted_blocks = 0;
+    // Code installed at the moment
+    size_t live_code_bytes = 0;
+    Dispatch dispatch;
+
+    void writeJson(std::ostream &out) const;
+    void writeText(std::ostream &out) const;
+};
+
+}  // namespace simulator::compiler
+
+#endif
@@ -2,10 +2,15 @@
 #define INTERPRETER_BB_H
 
 // #include "interpreter/executor.h"
+#include "interpreter/bb_arena.h"
 #include "interpreter/instruction.h"
+#include "interpreter/gpr.h"
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
 
 namespace simulator::interpreter {
 
@@ -13,17 +18,17 @@ class Executor;
 
 class BB final {
 public:
-    static constexpr size_t MAX_SIZE = 9;
+    // Straight-line code is cut only here, so that a block spans at most two pages
+    static constexpr size_t MAX_SIZE = 1024;
 
 private:
-    size_t curSize = 0;
-    std::array<uint32_t, MAX_SIZE> raw_instrs_;
+    std::vector<uint32_t> raw_instrs_;
 
 public:
     bool add_instr(uint32_t raw_instr)
     {
-        [[unlikely]] if (curSize >= MAX_SIZE) return false;
-        raw_instrs_[curSize++] = raw_instr;
+        [[unlikely]] if (raw_instrs_.size() >= MAX_SIZE) return false;
+        raw_instrs_.push_back(raw_instr);
         return true;
     }
 
@@ -33,49 +38,177 @@ public:
     }
     [[nodiscard]] inline auto cend() const
     {
-        return raw_instrs_.cbegin() + curSize;
+        return raw_instrs_.cend();
     }
     inline void clear()
     {
-        curSize = 0;
+        raw_instrs_.clear();
     }
     inline size_t size() const
     {
-        return curSize;
+        return raw_instrs_.size();
+    }
+};
+
+// Hot path through consecutive basic blocks, compiled as a single region
+struct Trace final {
+    static constexpr size_t MAX_BLOCKS = 8;
+    // Blocks are long enough to make a few of them too much for one region
+    static constexpr size_t MAX_INSTRS = 2048;
+
+    std::vector<Instruction> instrs;
+    // Guest PC of every instruction
+    std::vector<Register> pcs;
+    // Start PC of every recorded block, the first one is the head
+    std::vector<Register> block_pcs;
+    size_t blocks = 0;
+
+    void append(const Instruction *begin, size_t size, Register pc)
+    {
+        for (size_t i = 0; i < size; ++i) {
+            instrs.push_back(begin[i]);
+            pcs.push_back(pc + i * sizeof(uint32_t));
+        }
+        block_pcs.push_back(pc);
+        ++blocks;
+    }
+    void clear()
+    {
+        instrs.clear();
+        pcs.clear();
+        block_pcs.clear();
+        blocks = 0;
+    }
+};
+
+class DecodedBB;
+
+// Last target of an indirect jump, checked by the jump before it leaves to the dispatcher
+struct InlineCache final {
+    Register pc = 0;
+    DecodedBB *target = nullptr;
+};
+
+// Shadow stack of return addresses pushed by compiled calls, so that returns can skip the dispatcher.
+// It's only a prediction: entries are checked against the actual target and overflow wraps around
+struct ReturnStack final {
+    static constexpr size_t SIZE = 64;  // must be a power of 2
+    // JALR clears bit 0 of its target, so no return matches an empty entry, not even the final one to PC 0
+    static constexpr Register EMPTY_PC = 1;
+    struct Entry {
+        Register pc = EMPTY_PC;
+        // Chain slot of the caller for the return site
+        DecodedBB **slot = nullptr;
+    };
+
+    std::array<Entry, SIZE> entries {};
+    size_t top = 0;
+    // Return whose slot isn't linked yet, the dispatcher links it to the block it looks up
+    DecodedBB **miss_slot = nullptr;
+    Register miss_pc = 0;
+
+    // Slots belong to compiled regions, so the stack must be cleared whenever one of them is freed
+    void clear()
+    {
+        entries.fill({});
+        top = 0;
+        miss_slot = nullptr;
+    }
+};
+
+// Code compiled for a trace together with the chain slots of its exits
+struct CompiledRegion final {
+    // Compiled code returns the chained successor or nullptr if the dispatcher has to look it up
+    using CompiledEntry = DecodedBB *(*)(Executor *, const Instruction *);
+
+    Trace trace;
+    CompiledEntry entry = nullptr;
+    // Bytes of machine code behind entry, counted against the code cache limit
+    size_t code_size = 0;
+    // Chain slots are read by the exit stubs of compiled code, so their addresses must stay stable.
+    // Moving a deque keeps them valid, which allows compiling a region apart from its block
+    std::deque<DecodedBB *> successors;
+    std::vector<Register> successor_pcs;
+    std::deque<InlineCache> inline_caches;
+    // Instructions compiled as interpreter calls, consumed by the statistics
+    std::vector<InstructionId> fallbacks;
+
+    // Allocates a chain slot for an exit leading to pc
+    DecodedBB **addSuccessor(Register pc)
+    {
+        successor_pcs.push_back(pc);
+        return &successors.emplace_back(nullptr);
+    }
+    InlineCache *addInlineCache()
+    {
+        return &inline_caches.emplace_back();
     }
 };
 
 class DecodedBB final {
 public:
-    constexpr static size_t MAX_HOTNESS = 10;
-    using CompiledEntry = void (*)(Executor *, const Instruction *);
-    enum class CompileStatus : uint8_t { COMPILED, RAW };
+    using CompiledEntry = CompiledRegion::CompiledEntry;
+    // Baseline code counts its own runs, the dispatcher counts only interpreted ones
+    enum class CompileStatus : uint8_t { RAW, BASELINE, OPTIMIZED };
 
 private:
     size_t curSize = 0;
     size_t hotness_counter_ = 0;
-    std::array<Instruction, BB::MAX_SIZE + 1> body_;
-    CompiledEntry compiled_entry_ = nullptr;
+    // Instructions and the terminator live in the arena of the hart, the block only points to them
+    Instruction *body_ = nullptr;
+    size_t capacity_ = 0;
     CompileStatus comp_status_ = CompileStatus::RAW;
+    CompiledRegion region_;
+    // Chain slots of other blocks pointing to this one
+    std::vector<DecodedBB **> predecessors_;
+    // Changes every time the block is reused for another PC
+    size_t epoch_ = 0;
 
 public:
-    [[nodiscard]] inline auto getBeginBB() const
+    [[nodiscard]] inline const Instruction *getBeginBB() const
     {
-        return body_.cbegin();
+        return body_;
     }
     inline bool add_instr(const Instruction &decodedInstr)
     {
-        [[unlikely]] if (curSize >= BB::MAX_SIZE + 1) return false;  // maybe more verbose output
+        // The last slot is kept for the terminator
+        [[unlikely]] if (curSize + 1 >= capacity_) return false;
         body_[curSize++] = decodedInstr;
         return true;
     }
-    inline void clear()
+    // Empties the block, the body is reused if size instructions and the terminator fit into it
+    inline void reserve(size_t size, BBArena &arena)
     {
         curSize = 0;
+        if (size + 1 <= capacity_)
+            return;
+        arena.release(capacity_);
+        body_ = arena.allocate(size + 1);
+        capacity_ = size + 1;
     }
-    inline void addTerminator()
+    // Copies the body into another arena, the current one is about to be freed
+    inline void moveBody(BBArena &arena)
     {
-        body_[curSize] = Instruction {.inst_id = BB_END_INST};
+        auto *body = arena.allocate(curSize + 1);
+        std::copy_n(body_, curSize + 1, body);
+        body_ = body;
+        capacity_ = curSize + 1;
+    }
+    inline void dropBody()
+    {
+        body_ = nullptr;
+        capacity_ = 0;
+        curSize = 0;
+    }
+    // Gives the body back to the arena it was reserved from, for blocks which don't outlive their use
+    inline void releaseBody(BBArena &arena)
+    {
+        arena.release(capacity_);
+        dropBody();
+    }
+    inline void addTerminator(const void *handler)
+    {
+        body_[curSize] = Instruction {.inst_id = BB_END_INST, .handler = handler};
     }
     inline size_t size() const
     {
@@ -83,12 +216,16 @@ public:
     }
     inline void incrementHotness()
     {
-        hotness_counter_ = std::min(hotness_counter_ + 1, MAX_HOTNESS);
+        ++hotness_counter_;
     }
     inline auto getHotness()
     {
         return hotness_counter_;
     }
+    inline size_t *getHotnessPtr()
+    {
+        return &hotness_counter_;
+    }
     inline auto getCompileStatus()
     {
         return comp_status_;
@@ -99,23 +236,111 @@ public:
     }
     inline auto getCompiledEntry()
     {
-        return compiled_entry_;
+        return region_.entry;
     }
-    inline void setCompiledEntry(auto compiled_entry)
+    inline size_t getCodeSize() const
     {
-        compiled_entry_ = compiled_entry;
+        return region_.code_size;
     }
-    inline auto getRawData()
+    inline const Instruction *getRawData() const
     {
-        return body_.data();
+        return body_;
     }
-    const auto &getBody() const
+    inline const Instruction *getBody() const
     {
         return body_;
     }
-    auto &getBody()
+    inline const Trace &getTrace() const
     {
-        return body_;
+        return region_.trace;
+    }
+    // Targets of the direct exits of the compiled code
+    inline const std::vector<Register> &getSuccessorPcs() const
+    {
+        return region_.successor_pcs;
+    }
+    inline size_t getEpoch() const
+    {
+        return epoch_;
+    }
+    // Replaces the current code, chains leading to this block stay valid
+    inline void install(CompiledRegion &&region, CompileStatus status)
+    {
+        unlinkSuccessors();
+        region_ = std::move(region);
+        comp_status_ = status;
+    }
+    // Patches the exit stubs leading to pc, so the next run goes straight to target.
+    // Without a direct exit to pc the block has left through its indirect jump, which caches the target
+    bool link(Register pc, DecodedBB *target)
+    {
+        auto &successors = region_.successors;
+        bool linked = false;
+        bool has_exit = false;
+        for (size_t succ = 0; succ < successors.size(); ++succ) {
+            if (region_.successor_pcs[succ] != pc)
+                continue;
+            has_exit = true;
+            if (successors[succ] != target) {
+                target->attach(&successors[succ]);
+                linked = true;
+            }
+        }
+        for (auto &cache : region_.inline_caches) {
+            if (has_exit || cache.target == target)
+                continue;
+            if (cache.target != nullptr)
+                cache.target->detach(&cache.target);
+            cache.pc = pc;
+            target->attach(&cache.target);
+            linked = true;
+        }
+        return linked;
+    }
+    // Points a chain slot of another block to this one
+    void attach(DecodedBB **slot)
+    {
+        *slot = this;
+        predecessors_.push_back(slot);
+    }
+    // Must be called before the block is reused for another PC
+    void unlink()
+    {
+        for (auto *slot : predecessors_)
+            *slot = nullptr;
+        predecessors_.clear();
+        unlinkSuccessors();
+        // Code which is still being compiled for the old PC gets dropped on publishing
+        ++epoch_;
+    }
+    // Drops the code and the profile, the owner must have released the code already
+    void reset()
+    {
+        unlink();
+        region_ = {};
+        comp_status_ = CompileStatus::RAW;
+        hotness_counter_ = 0;
+    }
+
+private:
+    void detach(DecodedBB **slot)
+    {
+        predecessors_.erase(std::remove(predecessors_.begin(), predecessors_.end(), slot), predecessors_.end());
+    }
+    // Slots are about to be freed, so targets must forget them
+    void unlinkSuccessors()
+    {
+        for (auto &slot : region_.successors) {
+            if (slot != nullptr)
+                slot->detach(&slot);
+        }
+        for (auto &cache : region_.inline_caches) {
+            if (cache.target != nullptr)
+                cache.target->detach(&cache.target);
+        }
+        region_.successors.clear();
+        region_.successor_pcs.clear();
+        region_.inline_caches.clear();
     }
 };
 
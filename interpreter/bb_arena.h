@@ -0,0 +1,55 @@
+#ifndef INTERPRETER_BB_ARENA_H
+#define INTERPRETER_BB_ARENA_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "interpreter/instruction.h"
+
+namespace simulator::interpreter {
+
+// Bodies of decoded blocks are bump-allocated from large chunks, so blocks of any length lie next to each other.
+// Single bodies are never freed, the owner moves the live ones into a fresh arena once most of it is garbage
+class BBArena final {
+public:
+    // Instructions per chunk, every body must fit into one
+    static constexpr size_t CHUNK_SIZE = 1 << 14;
+
+    Instruction *allocate(size_t size)
+    {
+        assert(size <= CHUNK_SIZE);
+        [[unlikely]] if (chunks_.empty() || chunk_used_ + size > CHUNK_SIZE)
+        {
+            chunks_.push_back(std::make_unique<Instruction[]>(CHUNK_SIZE));
+            chunk_used_ = 0;
+        }
+        auto *body = chunks_.back().get() + chunk_used_;
+        chunk_used_ += size;
+        used_ += size;
+        live_ += size;
+        return body;
+    }
+    // Body of this size isn't referenced anymore
+    inline void release(size_t size)
+    {
+        live_ -= size;
+    }
+    // Garbage outweighs both the live bodies and a chunk, so compaction pays off
+    inline bool isFragmented() const
+    {
+        return used_ - live_ > std::max(live_, CHUNK_SIZE);
+    }
+
+private:
+    std::vector<std::unique_ptr<Instruction[]>> chunks_;
+    size_t chunk_used_ = 0;
+    size_t used_ = 0;
+    // Instructions in bodies which are still referenced
+    size_t live_ = 0;
+};
+
+}  // namespace simulator::interpreter
+
+#endif  // INTERPRETER_BB_ARENA_H
@@ -0,0 +1,70 @@
+#ifndef INTERPRETER_COSIM_TRACE_H
+#define INTERPRETER_COSIM_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include "configs/macros.hpp"
+#include "interpreter/gpr.h"
+#include "interpreter/instruction.h"
+
+namespace simulator::interpreter {
+
+// One executed instruction, written to the trace file as is
+struct CosimRecord final {
+    Register pc;
+    // Value of reg after the instruction, 0 when it writes nothing
+    Register value;
+    // GPR index, FP registers follow the GPRs, x0 when nothing is written
+    uint8_t reg;
+    uint8_t padding[7];
+};
+
+// Records are appended by the interpreter and by JIT code, which only leaves to flush a full buffer
+class CosimTrace final {
+public:
+    static constexpr size_t CAPACITY = 1 << 16;
+    static constexpr uint8_t FPR_BASE = 32;
+
+    explicit CosimTrace(bool is_enabled);
+    ~CosimTrace();
+    NO_COPY_SEMANTIC(CosimTrace)
+    NO_MOVE_SEMANTIC(CosimTrace)
+
+    inline void append(Register pc, uint8_t reg, Register value)
+    {
+        *cursor_++ = {pc, value, reg, {}};
+        if (cursor_ == end_)
+            flush();
+    }
+    // Writes the buffered records and starts filling the buffer from the beginning
+    void flush();
+
+    inline static auto getOffsetToCursor()
+    {
+        return offsetof(CosimTrace, cursor_);
+    }
+    inline static auto getOffsetToEnd()
+    {
+        return offsetof(CosimTrace, end_);
+    }
+
+private:
+    std::unique_ptr<CosimRecord[]> buffer_;
+    CosimRecord *cursor_ = nullptr;
+    CosimRecord *end_ = nullptr;
+    FILE *file_ = nullptr;
+};
+
+// Register written by the instruction as a CosimRecord::reg, rd of stores and branches is always x0
+uint8_t GetTracedReg(const Instruction &instr);
+
+inline void flushCosimTraceIface(CosimTrace *trace)
+{
+    trace->flush();
+}
+
+}  // namespace simulator::interpreter
+
+#endif  // INTERPRETER_COSIM_TRACE_H
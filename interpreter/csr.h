@@ -83,7 +83,12 @@ public:
         SCAUSE = 0x142,
         STVAL = 0x143,
         SIP = 0x144,
-        SATP = 0x180
+        SATP = 0x180,
+
+        // Floating-point CSRs, handled by the executor.
+        FFLAGS = 0x001,
+        FRM = 0x002,
+        FCSR = 0x003
     };
 
     [[nodiscard]] Register read(uint16_t addr)
@@ -3,21 +3,28 @@
 
 #include "interpreter/instruction.h"
 #include "interpreter/BB.h"
+#include "interpreter/executor.h"
 
 namespace simulator::interpreter {
 
 class Decoder final {
 public:
     [[nodiscard]] Instruction DecodeInstr(uint32_t raw_inst);
-    inline void DecodeBB(const BB &raw_bb, DecodedBB &decoded_bb)
+    // Body of decoded_bb is taken from arena unless the old one is large enough
+    inline void DecodeBB(const BB &raw_bb, DecodedBB &decoded_bb, BBArena &arena)
     {
-        decoded_bb.clear();
-        for (auto curIt = raw_bb.cbegin(), endIt = raw_bb.cend(); curIt != endIt; ++curIt)
-            decoded_bb.add_instr(DecodeInstr(*curIt));
-        decoded_bb.addTerminator();
+        decoded_bb.reserve(raw_bb.size(), arena);
+        for (auto curIt = raw_bb.cbegin(), endIt = raw_bb.cend(); curIt != endIt; ++curIt) {
+            auto instr = DecodeInstr(*curIt);
+            instr.handler = handlers_[instr.inst_id];
+            decoded_bb.add_instr(instr);
+        }
+        decoded_bb.addTerminator(handlers_[BB_END_INST]);
     }
 
 private:
+    const void *const *handlers_ = Executor::GetHandlers();
+
 #include "generated/instructions_decode_gen.h"
 };
 
@@ -4,25 +4,35 @@
 #include "interpreter/instruction.h"
 #include "interpreter/gpr.h"
 #include "interpreter/csr.h"
+#include "interpreter/fpr.h"
+#include "interpreter/cosim_trace.h"
 #include "memory/includes/mmu.hpp"
 #include "interpreter/BB.h"
 #include <iostream>
+#include <utility>
 
 namespace simulator::interpreter {
 
 class Executor {
 public:
-    Executor(mem::MMU *mmu, uintptr_t entry_point, bool is_cosim) : mmu_(mmu), is_cosim_(is_cosim)
+    Executor(mem::MMU *mmu, uintptr_t entry_point, bool is_cosim)
+        : cosim_trace_(is_cosim), mmu_(mmu), is_cosim_(is_cosim)
     {
         gprf_.write(GPR_file::GPR_n::PC, entry_point);
+        resetHostFPU();
     };
     NO_COPY_SEMANTIC(Executor)
     NO_MOVE_SEMANTIC(Executor)
 
     void RunInstr(const Instruction *inst);
+    // Blocks have to be decoded with the handlers of the threaded interpreter
     void RunBB(const DecodedBB &bb);
+    // Addresses of the threaded interpreter handlers indexed by InstructionId: labels of the computed goto
+    // interpreter or functions of the tail-calling one
+    static const void *const *GetHandlers();
 
-    void GetTrace(const simulator::Instruction *cur_instr);
+    // Appends the register instr has written, pc is the one it was executed at
+    void RecordTrace(const Instruction *instr, Register pc);
 
     [[nodiscard]] inline Register getPC()
     {
@@ -39,15 +49,72 @@ public:
         return csrf_;
     }
 
+    // fflags include the exceptions JIT code has raised since the last sync
+    inline const FPR_file &getFPRfile()
+    {
+        syncHostFlags();
+        return fprf_;
+    }
+
     inline static auto getOffsetToGprf()
     {
         return offsetof(interpreter::Executor, gprf_);
     }
 
+    inline static auto getOffsetToFprf()
+    {
+        return offsetof(interpreter::Executor, fprf_);
+    }
+
+    inline static auto getOffsetToCosimTrace()
+    {
+        return offsetof(interpreter::Executor, cosim_trace_);
+    }
+
+    inline static auto getOffsetToCompiledInstrs()
+    {
+        return offsetof(interpreter::Executor, compiled_instrs_);
+    }
+
+    // Instructions retired by compiled code since the last call
+    inline size_t takeCompiledInstrs()
+    {
+        return std::exchange(compiled_instrs_, 0);
+    }
+
 private:
+#if defined(INTERPRETER_MUSTTAIL)
+    // Instruction::handler of the tail-calling interpreter
+    using TailHandler = void (*)(Executor *executor, const Instruction *instr);
+#else
+    // Jumps from handler to handler through Instruction::handler until the terminator.
+    // Returns the handler table without running anything when executor is nullptr
+    static const void *const *RunThreaded(Executor *executor, const Instruction *instr);
+#endif
 #include "generated/executor_gen.h"
+    // fflags, frm and fcsr live in the FP register file, the rest in the CSR file
+    Register readCSR(uint16_t addr);
+    void writeCSR(uint16_t addr, Register value);
+    // Resolves the dynamic rounding mode, reserved ones are illegal
+    uint8_t getRoundingMode(uint8_t rm) const;
+    void setHostRounding();
+    // Drops exceptions the host raised before the guest started
+    void resetHostFPU();
+    void syncHostFlags();
+    template <typename T>
+    T readF(uint8_t reg_n) const;
+    template <typename T>
+    void writeF(uint8_t reg_n, T value);
+    // rd = op(args...) under the rounding mode of the instruction, NaN results become canonical
+    template <typename T, typename Op, typename... Args>
+    void execFloatOp(uint8_t rd, uint8_t rm, Op op, Args... args);
+
     GPR_file gprf_;
     CSR_file csrf_;
+    FPR_file fprf_;
+    CosimTrace cosim_trace_;
+    // Every exit of compiled code adds the number of instructions on its path
+    size_t compiled_instrs_ = 0;
     mem::MMU *mmu_;
     bool is_cosim_ = false;
 };
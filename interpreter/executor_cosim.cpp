@@ -1,35 +1,84 @@
 #include "interpreter/executor.h"
 
+#include <iostream>
+#include "generated/instructions_enum_gen.h"
+#include "interpreter/cosim_trace.h"
+
 namespace simulator::interpreter {
 
-void Executor::GetTrace(const simulator::Instruction *cur_instr)
+CosimTrace::CosimTrace(bool is_enabled)
 {
-    FILE *dumpFile = fopen("instr_trace.trace", "a");
-    if (!dumpFile) {
-        std::cerr << "Error during file opening to emit instructions traces\n";
+    if (!is_enabled)
         return;
-    }
-
-    fprintf(dumpFile, "PC:%li \n", getPC());
-
-    fprintf(dumpFile, "rd: %hhu, ", cur_instr->rd);
-    fprintf(dumpFile, "rs1: %hhu, ", cur_instr->rs1);
-    fprintf(dumpFile, "rs2: %hhu, ", cur_instr->rs2);
-    fprintf(dumpFile, "rs3: %hhu, ", cur_instr->rs3);
-    fprintf(dumpFile, "imm: %x, ", cur_instr->imm & 0xFFF);
-    fprintf(dumpFile, "rm: %hhu\n", cur_instr->rm);
+    // Without the file records are still appended and then dropped, so traced code never sees a null cursor
+    file_ = fopen("instr_trace.trace", "wb");
+    if (!file_)
+        std::cerr << "Error during file opening to emit instructions traces\n";
+    buffer_ = std::make_unique<CosimRecord[]>(CAPACITY);
+    cursor_ = buffer_.get();
+    end_ = buffer_.get() + CAPACITY;
+}
 
-    auto &gprf = getGPRfile();
+CosimTrace::~CosimTrace()
+{
+    if (!file_)
+        return;
+    flush();
+    fclose(file_);
+}
 
-    fprintf(dumpFile, "rd: %lu, ", gprf.read(cur_instr->rd));
-    fprintf(dumpFile, "rs1: %lu, ", gprf.read(cur_instr->rs1));
-    fprintf(dumpFile, "rs2: %lu, ", gprf.read(cur_instr->rs2));
-    fprintf(dumpFile, "rs3: %lu, ", gprf.read(cur_instr->rs3));
-    fprintf(dumpFile, "rm: %lu\n", gprf.read(cur_instr->rm));
+void CosimTrace::flush()
+{
+    if (file_)
+        fwrite(buffer_.get(), sizeof(CosimRecord), cursor_ - buffer_.get(), file_);
+    cursor_ = buffer_.get();
+}
 
-    fprintf(dumpFile, "#################################\n");
+uint8_t GetTracedReg(const Instruction &instr)
+{
+    switch (instr.inst_id) {
+        // FP instructions with an integer result
+        case InstructionId::FEQ_S:
+        case InstructionId::FLT_S:
+        case InstructionId::FLE_S:
+        case InstructionId::FCLASS_S:
+        case InstructionId::FMV_X_W:
+        case InstructionId::FCVT_W_S:
+        case InstructionId::FCVT_WU_S:
+        case InstructionId::FCVT_L_S:
+        case InstructionId::FCVT_LU_S:
+        case InstructionId::FEQ_D:
+        case InstructionId::FLT_D:
+        case InstructionId::FLE_D:
+        case InstructionId::FCLASS_D:
+        case InstructionId::FMV_X_D:
+        case InstructionId::FCVT_W_D:
+        case InstructionId::FCVT_WU_D:
+        case InstructionId::FCVT_L_D:
+        case InstructionId::FCVT_LU_D:
+            return instr.rd;
+        default:
+            break;
+    }
+    // LOAD-FP, the fused multiply-adds and OP-FP
+    switch (instr.opcode) {
+        case 0b0000111:
+        case 0b1000011:
+        case 0b1000111:
+        case 0b1001011:
+        case 0b1001111:
+        case 0b1010011:
+            return CosimTrace::FPR_BASE + instr.rd;
+        default:
+            return instr.rd;
+    }
+}
 
-    fclose(dumpFile);
+void Executor::RecordTrace(const Instruction *instr, Register pc)
+{
+    auto reg = GetTracedReg(*instr);
+    Register value = reg < CosimTrace::FPR_BASE ? gprf_.read(reg) : fprf_.read(reg - CosimTrace::FPR_BASE);
+    cosim_trace_.append(pc, reg, value);
 }
 
 }  // namespace simulator::interpreter
@@ -3,9 +3,13 @@
 
 #include "interpreter/executor.h"
 #include "interpreter/gpr.h"
+#include "interpreter/host_fpu.h"
 #include "interpreter/instruction.h"
 
+#include <bit>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 namespace simulator::interpreter {
 
@@ -14,7 +18,104 @@ namespace simulator::interpreter {
         gprf_.write(GPR_file::GPR_n::PC, gprf_.read(GPR_file::GPR_n::PC) + 4); \
     }
 
-void Executor::exec_LUI([[maybe_unused]] Instruction inst)
+inline Register Executor::readCSR(uint16_t addr)
+{
+    switch (addr) {
+        case CSR_file::FFLAGS:
+            syncHostFlags();
+            return fprf_.getFflags();
+        case CSR_file::FRM:
+            return fprf_.getFrm();
+        case CSR_file::FCSR:
+            syncHostFlags();
+            return (fprf_.getFrm() << 5) | fprf_.getFflags();
+        default:
+            return csrf_.read(addr);
+    }
+}
+
+inline void Executor::writeCSR(uint16_t addr, Register value)
+{
+    switch (addr) {
+        case CSR_file::FFLAGS:
+            syncHostFlags();
+            fprf_.setFflags(value);
+            break;
+        case CSR_file::FRM:
+            fprf_.setFrm(value);
+            setHostRounding();
+            break;
+        case CSR_file::FCSR:
+            syncHostFlags();
+            fprf_.setFflags(value);
+            fprf_.setFrm(value >> 5);
+            setHostRounding();
+            break;
+        default:
+            csrf_.write(addr, value);
+            break;
+    }
+}
+
+inline uint8_t Executor::getRoundingMode(uint8_t rm) const
+{
+    if (rm == FPR_file::DYN)
+        rm = fprf_.getFrm();
+    if (rm > FPR_file::RMM) {
+        std::cerr << "Illegal rounding mode " << static_cast<int>(rm) << std::endl;
+        std::abort();
+    }
+    return rm;
+}
+
+inline void Executor::setHostRounding()
+{
+    _mm_setcsr((_mm_getcsr() & ~MXCSR_RC) | GetHostRounding(fprf_.getFrm()));
+}
+
+inline void Executor::resetHostFPU()
+{
+    _mm_setcsr(_mm_getcsr() & ~MXCSR_FLAGS);
+    setHostRounding();
+}
+
+inline void Executor::syncHostFlags()
+{
+    uint32_t mxcsr = _mm_getcsr();
+    fprf_.raise(GetGuestFlags(mxcsr));
+    _mm_setcsr(mxcsr & ~MXCSR_FLAGS);
+}
+
+template <typename T>
+inline T Executor::readF(uint8_t reg_n) const
+{
+    if constexpr (std::is_same_v<T, float>) {
+        return fprf_.readS(reg_n);
+    } else {
+        return fprf_.readD(reg_n);
+    }
+}
+
+template <typename T>
+inline void Executor::writeF(uint8_t reg_n, T value)
+{
+    if constexpr (std::is_same_v<T, float>) {
+        fprf_.writeS(reg_n, value);
+    } else {
+        fprf_.writeD(reg_n, value);
+    }
+}
+
+template <typename T, typename Op, typename... Args>
+inline void Executor::execFloatOp(uint8_t rd, uint8_t rm, Op op, Args... args)
+{
+    uint8_t flags = 0;
+    T res = RunOnHostFPU(getRoundingMode(rm), flags, op, args...);
+    fprf_.raise(flags);
+    writeF<T>(rd, Canonicalize(res));
+}
+
+void Executor::exec_LUI([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rd = inst.rd;
@@ -22,43 +123,40 @@ void Executor::exec_LUI([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_AUIPC([[maybe_unused]] Instruction inst)
+void Executor::exec_AUIPC([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rd = inst.rd;
     Register advanced_pc = gprf_.read(GPR_file::GPR_n::PC);
-    uint32_t shifted_imm = ApplyLeftShift<Immediate_t, 12>(imm);
-    advanced_pc += shifted_imm;
+    advanced_pc += imm;
     gprf_.write(rd, advanced_pc);
     NEXT()
 }
 
-void Executor::exec_JAL([[maybe_unused]] Instruction inst)
+void Executor::exec_JAL([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register rd = inst.rd;
-    Register signed_imm = GetSignedExtension<Register, 20>(imm);
     Register pc = gprf_.read(GPR_file::GPR_n::PC);
     auto advanced_pc = pc + 4;
-    pc += signed_imm;
+    pc += imm;
     gprf_.write(rd, advanced_pc);
     gprf_.write(GPR_file::GPR_n::PC, pc);
 }
 
-void Executor::exec_JALR([[maybe_unused]] Instruction inst)
+void Executor::exec_JALR([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
-    Register offset = (gprf_.read(rs1) + signed_imm) & (~static_cast<Register>(1));
+    Register offset = (gprf_.read(rs1) + imm) & (~static_cast<Register>(1));
     Register pc = gprf_.read(GPR_file::GPR_n::PC);
     pc += 4;
     gprf_.write(GPR_file::GPR_n::PC, offset);
     gprf_.write(rd, pc);
 }
 
-void Executor::exec_BEQ([[maybe_unused]] Instruction inst)
+void Executor::exec_BEQ([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rs1 = inst.rs1;
@@ -67,14 +165,14 @@ void Executor::exec_BEQ([[maybe_unused]] Instruction inst)
     Register rs1_val = gprf_.read(rs1);
     Register rs2_val = gprf_.read(rs2);
     if (rs1_val == rs2_val) {
-        Register offset = pc + GetSignedExtension<Register, 12>(imm);
+        Register offset = pc + imm;
         gprf_.write(GPR_file::GPR_n::PC, offset);
     } else {
         NEXT()
     }
 }
 
-void Executor::exec_BNE([[maybe_unused]] Instruction inst)
+void Executor::exec_BNE([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rs1 = inst.rs1;
@@ -83,14 +181,14 @@ void Executor::exec_BNE([[maybe_unused]] Instruction inst)
     Register rs1_val = gprf_.read(rs1);
     Register rs2_val = gprf_.read(rs2);
     if (rs1_val != rs2_val) {
-        Register offset = pc + GetSignedExtension<Register, 12>(imm);
+        Register offset = pc + imm;
         gprf_.write(GPR_file::GPR_n::PC, offset);
     } else {
         NEXT()
     }
 }
 
-void Executor::exec_BLT([[maybe_unused]] Instruction inst)
+void Executor::exec_BLT([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rs1 = inst.rs1;
@@ -99,14 +197,14 @@ void Executor::exec_BLT([[maybe_unused]] Instruction inst)
     SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
     SRegister rs2_val = GetSignedForm<Register>(gprf_.read(rs2));
     if (rs1_val < rs2_val) {
-        Register offset = pc + GetSignedExtension<Register, 12>(imm);
+        Register offset = pc + imm;
         gprf_.write(GPR_file::GPR_n::PC, offset);
     } else {
         NEXT()
     }
 }
 
-void Executor::exec_BLTU([[maybe_unused]] Instruction inst)
+void Executor::exec_BLTU([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rs1 = inst.rs1;
@@ -115,14 +213,14 @@ void Executor::exec_BLTU([[maybe_unused]] Instruction inst)
     Register rs1_val = gprf_.read(rs1);
     Register rs2_val = gprf_.read(rs2);
     if (rs1_val < rs2_val) {
-        Register offset = pc + GetSignedExtension<Register, 12>(imm);
+        Register offset = pc + imm;
         gprf_.write(GPR_file::GPR_n::PC, offset);
     } else {
         NEXT()
     }
 }
 
-void Executor::exec_BGE([[maybe_unused]] Instruction inst)
+void Executor::exec_BGE([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rs1 = inst.rs1;
@@ -131,14 +229,14 @@ void Executor::exec_BGE([[maybe_unused]] Instruction inst)
     SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
     SRegister rs2_val = GetSignedForm<Register>(gprf_.read(rs2));
     if (rs1_val >= rs2_val) {
-        Register offset = pc + GetSignedExtension<Register, 12>(imm);
+        Register offset = pc + imm;
         gprf_.write(GPR_file::GPR_n::PC, offset);
     } else {
         NEXT()
     }
 }
 
-void Executor::exec_BGEU([[maybe_unused]] Instruction inst)
+void Executor::exec_BGEU([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rs1 = inst.rs1;
@@ -147,118 +245,112 @@ void Executor::exec_BGEU([[maybe_unused]] Instruction inst)
     Register rs1_val = gprf_.read(rs1);
     Register rs2_val = gprf_.read(rs2);
     if (rs1_val >= rs2_val) {
-        Register offset = pc + GetSignedExtension<Register, 12>(imm);
+        Register offset = pc + imm;
         gprf_.write(GPR_file::GPR_n::PC, offset);
     } else {
         NEXT()
     }
 }
 
-void Executor::exec_ADDI([[maybe_unused]] Instruction inst)
+void Executor::exec_ADDI([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
-    Register res = gprf_.read(rs1) + signed_imm;
+    Register res = gprf_.read(rs1) + imm;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SLTI([[maybe_unused]] Instruction inst)
+void Executor::exec_SLTI([[maybe_unused]] const Instruction &inst)
 {
     Immediate_t imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    SRegister signed_imm = GetSignedForm<Register>(GetSignedExtension<Register, 12>(imm));
     SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
-    Register res = rs1_val < signed_imm ? 1 : 0;
+    Register res = rs1_val < imm ? 1 : 0;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SLTIU([[maybe_unused]] Instruction inst)
+void Executor::exec_SLTIU([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register res = rs1_val < signed_imm ? 1 : 0;
+    Register res = rs1_val < imm ? 1 : 0;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_XORI([[maybe_unused]] Instruction inst)
+void Executor::exec_XORI([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register res = rs1_val ^ signed_imm;
+    Register res = rs1_val ^ imm;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_ANDI([[maybe_unused]] Instruction inst)
+void Executor::exec_ANDI([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register res = rs1_val & signed_imm;
+    Register res = rs1_val & imm;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_ORI([[maybe_unused]] Instruction inst)
+void Executor::exec_ORI([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register res = rs1_val | signed_imm;
+    Register res = rs1_val | imm;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SLLI([[maybe_unused]] Instruction inst)
+void Executor::exec_SLLI([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Immediate_t shamt = inst.GetShamt();
+    Immediate_t shamt = inst.imm;
     Register rs1_val = gprf_.read(rs1);
     Register res = rs1_val << shamt;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SRLI([[maybe_unused]] Instruction inst)
+void Executor::exec_SRLI([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Immediate_t shamt = inst.GetShamt();
+    Immediate_t shamt = inst.imm;
     Register rs1_val = gprf_.read(rs1);
     Register res = rs1_val >> shamt;
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SRAI([[maybe_unused]] Instruction inst)
+void Executor::exec_SRAI([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Immediate_t shamt = inst.GetShamt();
+    Immediate_t shamt = inst.imm;
     SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
     SRegister res = rs1_val >> shamt;
     gprf_.write(rd, GetUnsignedForm<SRegister>(res));
     NEXT()
 }
 
-void Executor::exec_ADD([[maybe_unused]] Instruction inst)
+void Executor::exec_ADD([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -270,7 +362,7 @@ void Executor::exec_ADD([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SUB([[maybe_unused]] Instruction inst)
+void Executor::exec_SUB([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -282,7 +374,7 @@ void Executor::exec_SUB([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SLL([[maybe_unused]] Instruction inst)
+void Executor::exec_SLL([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -294,7 +386,7 @@ void Executor::exec_SLL([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SRL([[maybe_unused]] Instruction inst)
+void Executor::exec_SRL([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -306,7 +398,7 @@ void Executor::exec_SRL([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SRA([[maybe_unused]] Instruction inst)
+void Executor::exec_SRA([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -318,7 +410,7 @@ void Executor::exec_SRA([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SLT([[maybe_unused]] Instruction inst)
+void Executor::exec_SLT([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -330,7 +422,7 @@ void Executor::exec_SLT([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SLTU([[maybe_unused]] Instruction inst)
+void Executor::exec_SLTU([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -342,7 +434,7 @@ void Executor::exec_SLTU([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_XOR([[maybe_unused]] Instruction inst)
+void Executor::exec_XOR([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -354,7 +446,7 @@ void Executor::exec_XOR([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_AND([[maybe_unused]] Instruction inst)
+void Executor::exec_AND([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -366,7 +458,7 @@ void Executor::exec_AND([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_OR([[maybe_unused]] Instruction inst)
+void Executor::exec_OR([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -378,52 +470,51 @@ void Executor::exec_OR([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_ADDIW([[maybe_unused]] Instruction inst)
+void Executor::exec_ADDIW([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register res = GetSignedExtension<Register, 32>(rs1_val + signed_imm);
+    Register res = GetSignedExtension<Register, 32>(rs1_val + imm);
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SLLIW([[maybe_unused]] Instruction inst)
+void Executor::exec_SLLIW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Immediate_t shamt = inst.GetShamt();
+    Immediate_t shamt = inst.imm;
     Register rs1_val = gprf_.read(rs1);
     Register res = GetSignedExtension<Register, 32>(rs1_val << shamt);
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SRLIW([[maybe_unused]] Instruction inst)
+void Executor::exec_SRLIW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Immediate_t shamt = inst.GetShamt();
+    Immediate_t shamt = inst.imm;
     Register rs1_val = gprf_.read(rs1);
     Register res = GetSignedExtension<Register, 32>(rs1_val >> shamt);
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SRAIW([[maybe_unused]] Instruction inst)
+void Executor::exec_SRAIW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Immediate_t shamt = inst.GetShamt();
+    Immediate_t shamt = inst.imm;
     SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
     Register res = GetSignedExtension<Register, 32>(GetUnsignedForm<SRegister>(rs1_val >> shamt));
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_ADDW([[maybe_unused]] Instruction inst)
+void Executor::exec_ADDW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -435,7 +526,7 @@ void Executor::exec_ADDW([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SUBW([[maybe_unused]] Instruction inst)
+void Executor::exec_SUBW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -447,7 +538,7 @@ void Executor::exec_SUBW([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SLLW([[maybe_unused]] Instruction inst)
+void Executor::exec_SLLW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -459,7 +550,7 @@ void Executor::exec_SLLW([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SRLW([[maybe_unused]] Instruction inst)
+void Executor::exec_SRLW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -471,7 +562,7 @@ void Executor::exec_SRLW([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_SRAW([[maybe_unused]] Instruction inst)
+void Executor::exec_SRAW([[maybe_unused]] const Instruction &inst)
 {
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
@@ -483,158 +574,147 @@ void Executor::exec_SRAW([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_LB([[maybe_unused]] Instruction inst)
+void Executor::exec_LB([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     int8_t val = GetSignedForm<uint8_t>(mmu_->LoadByte(addr));
     Register res = GetSignedExtension<Register, 8>(GetUnsignedForm<int8_t>(val));
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_LH([[maybe_unused]] Instruction inst)
+void Executor::exec_LH([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     int16_t val = GetSignedForm<uint16_t>(mmu_->LoadTwoBytesFast(addr));
     Register res = GetSignedExtension<Register, 16>(GetUnsignedForm<int16_t>(val));
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_LW([[maybe_unused]] Instruction inst)
+void Executor::exec_LW([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     int32_t val = GetSignedForm<uint32_t>(mmu_->LoadFourBytesFast(addr));
     Register res = GetSignedExtension<Register, 32>(GetUnsignedForm<int32_t>(val));
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_LD([[maybe_unused]] Instruction inst)
+void Executor::exec_LD([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     SRegister val = GetSignedForm<Register>(mmu_->LoadEightBytesFast(addr));
     Register res = GetUnsignedForm<SRegister>(val);
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_SB([[maybe_unused]] Instruction inst)
+void Executor::exec_SB([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rs1 = inst.rs1;
     Register_t rs2 = inst.rs2;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     Register rs2_val = gprf_.read(rs2);
     uint8_t val = static_cast<uint8_t>(rs2_val);
     mmu_->StoreByte(addr, val);
     NEXT()
 }
 
-void Executor::exec_SH([[maybe_unused]] Instruction inst)
+void Executor::exec_SH([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rs1 = inst.rs1;
     Register_t rs2 = inst.rs2;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     Register rs2_val = gprf_.read(rs2);
     uint16_t val = static_cast<uint16_t>(rs2_val);
     mmu_->StoreTwoBytesFast(addr, val);
     NEXT()
 }
 
-void Executor::exec_SW([[maybe_unused]] Instruction inst)
+void Executor::exec_SW([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rs1 = inst.rs1;
     Register_t rs2 = inst.rs2;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     Register rs2_val = gprf_.read(rs2);
     uint32_t val = static_cast<uint32_t>(rs2_val);
     mmu_->StoreFourBytesFast(addr, val);
     NEXT()
 }
 
-void Executor::exec_SD([[maybe_unused]] Instruction inst)
+void Executor::exec_SD([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rs1 = inst.rs1;
     Register_t rs2 = inst.rs2;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     Register rs2_val = gprf_.read(rs2);
     Register val = static_cast<Register>(rs2_val);
     mmu_->StoreEightBytesFast(addr, val);
     NEXT()
 }
 
-void Executor::exec_LBU([[maybe_unused]] Instruction inst)
+void Executor::exec_LBU([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     Register res = mmu_->LoadByte(addr);
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_LHU([[maybe_unused]] Instruction inst)
+void Executor::exec_LHU([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     Register res = mmu_->LoadTwoBytesFast(addr);
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_LWU([[maybe_unused]] Instruction inst)
+void Executor::exec_LWU([[maybe_unused]] const Instruction &inst)
 {
-    Immediate_t imm = inst.imm;
+    Register imm = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register signed_imm = GetSignedExtension<Register, 12>(imm);
     Register rs1_val = gprf_.read(rs1);
-    Register addr = rs1_val + signed_imm;
+    Register addr = rs1_val + imm;
     Register res = mmu_->LoadFourBytesFast(addr);
     gprf_.write(rd, res);
     NEXT()
 }
 
-void Executor::exec_ECALL([[maybe_unused]] Instruction inst)
+void Executor::exec_ECALL([[maybe_unused]] const Instruction &inst)
 {
     Register syscall = gprf_.read(GPR_file::GPR_n::X17);
     switch (syscall) {
@@ -655,625 +735,950 @@ void Executor::exec_ECALL([[maybe_unused]] Instruction inst)
     NEXT()
 }
 
-void Executor::exec_FENCE([[maybe_unused]] Instruction inst)
+void Executor::exec_FENCE([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    // Single hart sees its own memory accesses in program order
+    NEXT()
 }
-void Executor::exec_FENCE_I([[maybe_unused]] Instruction inst)
+void Executor::exec_FENCE_I([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    mmu_->FlushCodePages();
+    NEXT()
 }
-void Executor::exec_MUL([[maybe_unused]] Instruction inst)
+void Executor::exec_MUL([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    Register rs1_val = gprf_.read(rs1);
+    Register rs2_val = gprf_.read(rs2);
+    Register res = rs1_val * rs2_val;
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_MULH([[maybe_unused]] Instruction inst)
+
+void Executor::exec_MULH([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
+    SRegister rs2_val = GetSignedForm<Register>(gprf_.read(rs2));
+    Register res = static_cast<unsigned __int128>(static_cast<__int128>(rs1_val) * rs2_val) >> 64;
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_MULHSU([[maybe_unused]] Instruction inst)
+
+void Executor::exec_MULHSU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
+    Register rs2_val = gprf_.read(rs2);
+    Register res = static_cast<unsigned __int128>(static_cast<__int128>(rs1_val) * rs2_val) >> 64;
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_MULHU([[maybe_unused]] Instruction inst)
+
+void Executor::exec_MULHU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    Register rs1_val = gprf_.read(rs1);
+    Register rs2_val = gprf_.read(rs2);
+    Register res = (static_cast<unsigned __int128>(rs1_val) * rs2_val) >> 64;
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_DIV([[maybe_unused]] Instruction inst)
+
+void Executor::exec_DIV([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
+    SRegister rs2_val = GetSignedForm<Register>(gprf_.read(rs2));
+    Register res;
+    // Division by zero gives all ones, overflow gives the dividend
+    if (rs2_val == 0) {
+        res = ~Register(0);
+    } else if (rs1_val == std::numeric_limits<SRegister>::min() && rs2_val == -1) {
+        res = rs1_val;
+    } else {
+        res = rs1_val / rs2_val;
+    }
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_DIVU([[maybe_unused]] Instruction inst)
+
+void Executor::exec_DIVU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    Register rs1_val = gprf_.read(rs1);
+    Register rs2_val = gprf_.read(rs2);
+    Register res = rs2_val == 0 ? ~Register(0) : rs1_val / rs2_val;
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_REM([[maybe_unused]] Instruction inst)
+
+void Executor::exec_REM([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    SRegister rs1_val = GetSignedForm<Register>(gprf_.read(rs1));
+    SRegister rs2_val = GetSignedForm<Register>(gprf_.read(rs2));
+    Register res;
+    // Remainder by zero gives the dividend, overflow gives zero
+    if (rs2_val == 0) {
+        res = rs1_val;
+    } else if (rs1_val == std::numeric_limits<SRegister>::min() && rs2_val == -1) {
+        res = 0;
+    } else {
+        res = rs1_val % rs2_val;
+    }
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_REMU([[maybe_unused]] Instruction inst)
+
+void Executor::exec_REMU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    Register rs1_val = gprf_.read(rs1);
+    Register rs2_val = gprf_.read(rs2);
+    Register res = rs2_val == 0 ? rs1_val : rs1_val % rs2_val;
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_MULW([[maybe_unused]] Instruction inst)
+
+void Executor::exec_MULW([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    Register rs1_val = gprf_.read(rs1);
+    Register rs2_val = gprf_.read(rs2);
+    Register res = GetSignedExtension<Register, 32>(rs1_val * rs2_val);
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_DIVW([[maybe_unused]] Instruction inst)
+
+void Executor::exec_DIVW([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    int32_t rs1_val = static_cast<int32_t>(gprf_.read(rs1));
+    int32_t rs2_val = static_cast<int32_t>(gprf_.read(rs2));
+    int32_t quot;
+    if (rs2_val == 0) {
+        quot = -1;
+    } else if (rs1_val == std::numeric_limits<int32_t>::min() && rs2_val == -1) {
+        quot = rs1_val;
+    } else {
+        quot = rs1_val / rs2_val;
+    }
+    Register res = static_cast<SRegister>(quot);
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_DIVUW([[maybe_unused]] Instruction inst)
+
+void Executor::exec_DIVUW([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    uint32_t rs1_val = static_cast<uint32_t>(gprf_.read(rs1));
+    uint32_t rs2_val = static_cast<uint32_t>(gprf_.read(rs2));
+    uint32_t quot = rs2_val == 0 ? ~uint32_t(0) : rs1_val / rs2_val;
+    Register res = GetSignedExtension<Register, 32>(quot);
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_REMW([[maybe_unused]] Instruction inst)
+
+void Executor::exec_REMW([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    int32_t rs1_val = static_cast<int32_t>(gprf_.read(rs1));
+    int32_t rs2_val = static_cast<int32_t>(gprf_.read(rs2));
+    int32_t rem;
+    if (rs2_val == 0) {
+        rem = rs1_val;
+    } else if (rs1_val == std::numeric_limits<int32_t>::min() && rs2_val == -1) {
+        rem = 0;
+    } else {
+        rem = rs1_val % rs2_val;
+    }
+    Register res = static_cast<SRegister>(rem);
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_REMUW([[maybe_unused]] Instruction inst)
+
+void Executor::exec_REMUW([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register_t rd = inst.rd;
+    Register_t rs1 = inst.rs1;
+    Register_t rs2 = inst.rs2;
+    uint32_t rs1_val = static_cast<uint32_t>(gprf_.read(rs1));
+    uint32_t rs2_val = static_cast<uint32_t>(gprf_.read(rs2));
+    uint32_t rem = rs2_val == 0 ? rs1_val : rs1_val % rs2_val;
+    Register res = GetSignedExtension<Register, 32>(rem);
+    gprf_.write(rd, res);
+    NEXT()
 }
-void Executor::exec_AMOADD_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOADD_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOXOR_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOXOR_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOOR_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOOR_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOAND_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOAND_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMIN_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMIN_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMAX_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMAX_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMINU_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMINU_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMAXU_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMAXU_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOSWAP_W([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOSWAP_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_LR_W([[maybe_unused]] Instruction inst)
+void Executor::exec_LR_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_SC_W([[maybe_unused]] Instruction inst)
+void Executor::exec_SC_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOADD_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOADD_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOXOR_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOXOR_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOOR_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOOR_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOAND_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOAND_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMIN_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMIN_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMAX_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMAX_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMINU_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMINU_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOMAXU_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOMAXU_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_AMOSWAP_D([[maybe_unused]] Instruction inst)
+void Executor::exec_AMOSWAP_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_LR_D([[maybe_unused]] Instruction inst)
+void Executor::exec_LR_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_SC_D([[maybe_unused]] Instruction inst)
+void Executor::exec_SC_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_EBREAK([[maybe_unused]] Instruction inst)
+void Executor::exec_EBREAK([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_URET([[maybe_unused]] Instruction inst)
+void Executor::exec_URET([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_SRET([[maybe_unused]] Instruction inst)
+void Executor::exec_SRET([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_MRET([[maybe_unused]] Instruction inst)
+void Executor::exec_MRET([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_DRET([[maybe_unused]] Instruction inst)
+void Executor::exec_DRET([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_SFENCE_VMA([[maybe_unused]] Instruction inst)
+void Executor::exec_SFENCE_VMA([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_WFI([[maybe_unused]] Instruction inst)
+void Executor::exec_WFI([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_CSRRW([[maybe_unused]] Instruction inst)
+void Executor::exec_CSRRW([[maybe_unused]] const Instruction &inst)
 {
     uint16_t csr_addr = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register csr_val = csrf_.read(csr_addr);
-    csrf_.write(csr_addr, gprf_.read(rs1));
+    Register csr_val = readCSR(csr_addr);
+    writeCSR(csr_addr, gprf_.read(rs1));
     gprf_.write(rd, csr_val);
+    NEXT()
 }
-void Executor::exec_CSRRS([[maybe_unused]] Instruction inst)
+void Executor::exec_CSRRS([[maybe_unused]] const Instruction &inst)
 {
     uint16_t csr_addr = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register csr_val = csrf_.read(csr_addr);
-    csrf_.write(csr_addr, csr_val | gprf_.read(rs1));
+    Register csr_val = readCSR(csr_addr);
+    writeCSR(csr_addr, csr_val | gprf_.read(rs1));
     gprf_.write(rd, csr_val);
+    NEXT()
 }
-void Executor::exec_CSRRC([[maybe_unused]] Instruction inst)
+void Executor::exec_CSRRC([[maybe_unused]] const Instruction &inst)
 {
     uint16_t csr_addr = inst.imm;
     Register_t rd = inst.rd;
     Register_t rs1 = inst.rs1;
-    Register csr_val = csrf_.read(csr_addr);
-    csrf_.write(csr_addr, csr_val & (~gprf_.read(rs1)));
+    Register csr_val = readCSR(csr_addr);
+    writeCSR(csr_addr, csr_val & (~gprf_.read(rs1)));
     gprf_.write(rd, csr_val);
+    NEXT()
 }
-void Executor::exec_CSRRWI([[maybe_unused]] Instruction inst)
+void Executor::exec_CSRRWI([[maybe_unused]] const Instruction &inst)
 {
     uint16_t csr_addr = inst.imm;
     Register_t rd = inst.rd;
     uint64_t zimm = inst.rs1;
-    Register csr_val = csrf_.read(csr_addr);
-    csrf_.write(csr_addr, zimm);
+    Register csr_val = readCSR(csr_addr);
+    writeCSR(csr_addr, zimm);
     gprf_.write(rd, csr_val);
+    NEXT()
 }
-void Executor::exec_CSRRSI([[maybe_unused]] Instruction inst)
+void Executor::exec_CSRRSI([[maybe_unused]] const Instruction &inst)
 {
     uint16_t csr_addr = inst.imm;
     Register_t rd = inst.rd;
     uint64_t zimm = inst.rs1;
-    Register csr_val = csrf_.read(csr_addr);
-    csrf_.write(csr_addr, csr_val | zimm);
+    Register csr_val = readCSR(csr_addr);
+    writeCSR(csr_addr, csr_val | zimm);
     gprf_.write(rd, csr_val);
+    NEXT()
 }
-void Executor::exec_CSRRCI([[maybe_unused]] Instruction inst)
+void Executor::exec_CSRRCI([[maybe_unused]] const Instruction &inst)
 {
     uint16_t csr_addr = inst.imm;
     Register_t rd = inst.rd;
     uint64_t zimm = inst.rs1;
-    Register csr_val = csrf_.read(csr_addr);
-    csrf_.write(csr_addr, csr_val & (~zimm));
+    Register csr_val = readCSR(csr_addr);
+    writeCSR(csr_addr, csr_val & (~zimm));
     gprf_.write(rd, csr_val);
+    NEXT()
 }
-void Executor::exec_HFENCE_VVMA([[maybe_unused]] Instruction inst)
+void Executor::exec_HFENCE_VVMA([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_HFENCE_GVMA([[maybe_unused]] Instruction inst)
+void Executor::exec_HFENCE_GVMA([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FADD_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FADD_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](float lhs, float rhs) { return lhs + rhs; }, readF<float>(inst.rs1),
+                       readF<float>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FSUB_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FSUB_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](float lhs, float rhs) { return lhs - rhs; }, readF<float>(inst.rs1),
+                       readF<float>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FMUL_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FMUL_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](float lhs, float rhs) { return lhs * rhs; }, readF<float>(inst.rs1),
+                       readF<float>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FDIV_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FDIV_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](float lhs, float rhs) { return lhs / rhs; }, readF<float>(inst.rs1),
+                       readF<float>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FSGNJ_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJ_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    constexpr uint32_t SIGN = uint32_t(1) << 31;
+    auto lhs = std::bit_cast<uint32_t>(readF<float>(inst.rs1));
+    auto rhs = std::bit_cast<uint32_t>(readF<float>(inst.rs2));
+    writeF<float>(inst.rd, std::bit_cast<float>((lhs & ~SIGN) | (rhs & SIGN)));
+    NEXT()
 }
-void Executor::exec_FSGNJN_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJN_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    constexpr uint32_t SIGN = uint32_t(1) << 31;
+    auto lhs = std::bit_cast<uint32_t>(readF<float>(inst.rs1));
+    auto rhs = std::bit_cast<uint32_t>(readF<float>(inst.rs2));
+    writeF<float>(inst.rd, std::bit_cast<float>((lhs & ~SIGN) | (~rhs & SIGN)));
+    NEXT()
 }
-void Executor::exec_FSGNJX_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJX_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    constexpr uint32_t SIGN = uint32_t(1) << 31;
+    auto lhs = std::bit_cast<uint32_t>(readF<float>(inst.rs1));
+    auto rhs = std::bit_cast<uint32_t>(readF<float>(inst.rs2));
+    writeF<float>(inst.rd, std::bit_cast<float>((lhs & ~SIGN) | ((lhs ^ rhs) & SIGN)));
+    NEXT()
 }
-void Executor::exec_FMIN_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FMIN_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    writeF<float>(inst.rd, GetMinMax(readF<float>(inst.rs1), readF<float>(inst.rs2), false, flags));
+    fprf_.raise(flags);
+    NEXT()
 }
-void Executor::exec_FMAX_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FMAX_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    writeF<float>(inst.rd, GetMinMax(readF<float>(inst.rs1), readF<float>(inst.rs2), true, flags));
+    fprf_.raise(flags);
+    NEXT()
 }
-void Executor::exec_FSQRT_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FSQRT_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](float value) { return std::sqrt(value); }, readF<float>(inst.rs1));
+    NEXT()
 }
-void Executor::exec_FADD_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FADD_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](double lhs, double rhs) { return lhs + rhs; }, readF<double>(inst.rs1),
+                        readF<double>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FSUB_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FSUB_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](double lhs, double rhs) { return lhs - rhs; }, readF<double>(inst.rs1),
+                        readF<double>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FMUL_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FMUL_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](double lhs, double rhs) { return lhs * rhs; }, readF<double>(inst.rs1),
+                        readF<double>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FDIV_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FDIV_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](double lhs, double rhs) { return lhs / rhs; }, readF<double>(inst.rs1),
+                        readF<double>(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FSGNJ_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJ_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    constexpr Register SIGN = Register(1) << 63;
+    auto lhs = std::bit_cast<Register>(readF<double>(inst.rs1));
+    auto rhs = std::bit_cast<Register>(readF<double>(inst.rs2));
+    writeF<double>(inst.rd, std::bit_cast<double>((lhs & ~SIGN) | (rhs & SIGN)));
+    NEXT()
 }
-void Executor::exec_FSGNJN_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJN_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    constexpr Register SIGN = Register(1) << 63;
+    auto lhs = std::bit_cast<Register>(readF<double>(inst.rs1));
+    auto rhs = std::bit_cast<Register>(readF<double>(inst.rs2));
+    writeF<double>(inst.rd, std::bit_cast<double>((lhs & ~SIGN) | (~rhs & SIGN)));
+    NEXT()
 }
-void Executor::exec_FSGNJX_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJX_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    constexpr Register SIGN = Register(1) << 63;
+    auto lhs = std::bit_cast<Register>(readF<double>(inst.rs1));
+    auto rhs = std::bit_cast<Register>(readF<double>(inst.rs2));
+    writeF<double>(inst.rd, std::bit_cast<double>((lhs & ~SIGN) | ((lhs ^ rhs) & SIGN)));
+    NEXT()
 }
-void Executor::exec_FMIN_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FMIN_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    writeF<double>(inst.rd, GetMinMax(readF<double>(inst.rs1), readF<double>(inst.rs2), false, flags));
+    fprf_.raise(flags);
+    NEXT()
 }
-void Executor::exec_FMAX_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FMAX_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    writeF<double>(inst.rd, GetMinMax(readF<double>(inst.rs1), readF<double>(inst.rs2), true, flags));
+    fprf_.raise(flags);
+    NEXT()
 }
-void Executor::exec_FCVT_S_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_S_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](double value) { return static_cast<float>(value); },
+                       readF<double>(inst.rs1));
+    NEXT()
 }
-void Executor::exec_FCVT_D_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_D_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](float value) { return static_cast<double>(value); },
+                        readF<float>(inst.rs1));
+    NEXT()
 }
-void Executor::exec_FSQRT_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FSQRT_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](double value) { return std::sqrt(value); }, readF<double>(inst.rs1));
+    NEXT()
 }
-void Executor::exec_FADD_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FADD_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FSUB_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FSUB_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FMUL_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FMUL_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FDIV_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FDIV_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FSGNJ_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJ_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FSGNJN_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJN_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FSGNJX_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FSGNJX_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FMIN_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FMIN_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FMAX_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FMAX_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_S_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_S_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_Q_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_Q_S([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_D_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_D_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_Q_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_Q_D([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FSQRT_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FSQRT_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FLE_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FLE_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    auto lhs = readF<float>(inst.rs1);
+    auto rhs = readF<float>(inst.rs2);
+    if (std::isnan(lhs) || std::isnan(rhs))
+        fprf_.raise(FPR_file::NV);
+    gprf_.write(inst.rd, lhs <= rhs);
+    NEXT()
 }
-void Executor::exec_FLT_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FLT_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    auto lhs = readF<float>(inst.rs1);
+    auto rhs = readF<float>(inst.rs2);
+    if (std::isnan(lhs) || std::isnan(rhs))
+        fprf_.raise(FPR_file::NV);
+    gprf_.write(inst.rd, lhs < rhs);
+    NEXT()
 }
-void Executor::exec_FEQ_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FEQ_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    auto lhs = readF<float>(inst.rs1);
+    auto rhs = readF<float>(inst.rs2);
+    // Quiet comparison, only signaling NaNs are invalid
+    if (IsSignalingNaN(lhs) || IsSignalingNaN(rhs))
+        fprf_.raise(FPR_file::NV);
+    gprf_.write(inst.rd, lhs == rhs);
+    NEXT()
 }
-void Executor::exec_FLE_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FLE_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    auto lhs = readF<double>(inst.rs1);
+    auto rhs = readF<double>(inst.rs2);
+    if (std::isnan(lhs) || std::isnan(rhs))
+        fprf_.raise(FPR_file::NV);
+    gprf_.write(inst.rd, lhs <= rhs);
+    NEXT()
 }
-void Executor::exec_FLT_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FLT_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    auto lhs = readF<double>(inst.rs1);
+    auto rhs = readF<double>(inst.rs2);
+    if (std::isnan(lhs) || std::isnan(rhs))
+        fprf_.raise(FPR_file::NV);
+    gprf_.write(inst.rd, lhs < rhs);
+    NEXT()
 }
-void Executor::exec_FEQ_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FEQ_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    auto lhs = readF<double>(inst.rs1);
+    auto rhs = readF<double>(inst.rs2);
+    // Quiet comparison, only signaling NaNs are invalid
+    if (IsSignalingNaN(lhs) || IsSignalingNaN(rhs))
+        fprf_.raise(FPR_file::NV);
+    gprf_.write(inst.rd, lhs == rhs);
+    NEXT()
 }
-void Executor::exec_FLE_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FLE_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FLT_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FLT_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FEQ_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FEQ_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_W_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_W_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    auto value = ConvertToInt<int32_t>(readF<float>(inst.rs1), getRoundingMode(inst.rm), flags);
+    Register res = GetSignedExtension<Register, 32>(static_cast<uint32_t>(value));
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FCVT_WU_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_WU_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    auto value = ConvertToInt<uint32_t>(readF<float>(inst.rs1), getRoundingMode(inst.rm), flags);
+    Register res = GetSignedExtension<Register, 32>(static_cast<uint32_t>(value));
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FCVT_L_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_L_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    Register res = ConvertToInt<int64_t>(readF<float>(inst.rs1), getRoundingMode(inst.rm), flags);
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FCVT_LU_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_LU_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    Register res = ConvertToInt<uint64_t>(readF<float>(inst.rs1), getRoundingMode(inst.rm), flags);
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FMV_X_W([[maybe_unused]] Instruction inst)
+void Executor::exec_FMV_X_W([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    gprf_.write(inst.rd, GetSignedExtension<Register, 32>(fprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCLASS_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FCLASS_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    gprf_.write(inst.rd, Classify(readF<float>(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_W_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_W_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    auto value = ConvertToInt<int32_t>(readF<double>(inst.rs1), getRoundingMode(inst.rm), flags);
+    Register res = GetSignedExtension<Register, 32>(static_cast<uint32_t>(value));
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FCVT_WU_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_WU_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    auto value = ConvertToInt<uint32_t>(readF<double>(inst.rs1), getRoundingMode(inst.rm), flags);
+    Register res = GetSignedExtension<Register, 32>(static_cast<uint32_t>(value));
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FCVT_L_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_L_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    Register res = ConvertToInt<int64_t>(readF<double>(inst.rs1), getRoundingMode(inst.rm), flags);
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FCVT_LU_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_LU_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    uint8_t flags = 0;
+    Register res = ConvertToInt<uint64_t>(readF<double>(inst.rs1), getRoundingMode(inst.rm), flags);
+    fprf_.raise(flags);
+    gprf_.write(inst.rd, res);
+    NEXT()
 }
-void Executor::exec_FMV_X_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FMV_X_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    gprf_.write(inst.rd, fprf_.read(inst.rs1));
+    NEXT()
 }
-void Executor::exec_FCLASS_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FCLASS_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    gprf_.write(inst.rd, Classify(readF<double>(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_W_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_W_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_WU_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_WU_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_L_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_L_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_LU_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_LU_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FMV_X_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FMV_X_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCLASS_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FCLASS_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_S_W([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_S_W([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](int32_t value) { return static_cast<float>(value); },
+                       static_cast<int32_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_S_WU([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_S_WU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](uint32_t value) { return static_cast<float>(value); },
+                       static_cast<uint32_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_S_L([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_S_L([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](int64_t value) { return static_cast<float>(value); },
+                       static_cast<int64_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_S_LU([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_S_LU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(inst.rd, inst.rm, [](uint64_t value) { return static_cast<float>(value); },
+                       static_cast<uint64_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FMV_W_X([[maybe_unused]] Instruction inst)
+void Executor::exec_FMV_W_X([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    fprf_.write(inst.rd, FPR_file::NAN_BOX | static_cast<uint32_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_D_W([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_D_W([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](int32_t value) { return static_cast<double>(value); },
+                        static_cast<int32_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_D_WU([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_D_WU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](uint32_t value) { return static_cast<double>(value); },
+                        static_cast<uint32_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_D_L([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_D_L([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](int64_t value) { return static_cast<double>(value); },
+                        static_cast<int64_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FCVT_D_LU([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_D_LU([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(inst.rd, inst.rm, [](uint64_t value) { return static_cast<double>(value); },
+                        static_cast<uint64_t>(gprf_.read(inst.rs1)));
+    NEXT()
 }
-void Executor::exec_FMV_D_X([[maybe_unused]] Instruction inst)
+void Executor::exec_FMV_D_X([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    fprf_.write(inst.rd, gprf_.read(inst.rs1));
+    NEXT()
 }
-void Executor::exec_FCVT_Q_W([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_Q_W([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_Q_WU([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_Q_WU([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_Q_L([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_Q_L([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FCVT_Q_LU([[maybe_unused]] Instruction inst)
+void Executor::exec_FCVT_Q_LU([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FMV_Q_X([[maybe_unused]] Instruction inst)
+void Executor::exec_FMV_Q_X([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FLW([[maybe_unused]] Instruction inst)
+void Executor::exec_FLW([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register addr = gprf_.read(inst.rs1) + inst.imm;
+    fprf_.write(inst.rd, FPR_file::NAN_BOX | mmu_->LoadFourBytesFast(addr));
+    NEXT()
 }
-void Executor::exec_FLD([[maybe_unused]] Instruction inst)
+void Executor::exec_FLD([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register addr = gprf_.read(inst.rs1) + inst.imm;
+    fprf_.write(inst.rd, mmu_->LoadEightBytesFast(addr));
+    NEXT()
 }
-void Executor::exec_FLQ([[maybe_unused]] Instruction inst)
+void Executor::exec_FLQ([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FSW([[maybe_unused]] Instruction inst)
+void Executor::exec_FSW([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register addr = gprf_.read(inst.rs1) + inst.imm;
+    mmu_->StoreFourBytesFast(addr, static_cast<uint32_t>(fprf_.read(inst.rs2)));
+    NEXT()
 }
-void Executor::exec_FSD([[maybe_unused]] Instruction inst)
+void Executor::exec_FSD([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    Register addr = gprf_.read(inst.rs1) + inst.imm;
+    mmu_->StoreEightBytesFast(addr, fprf_.read(inst.rs2));
+    NEXT()
 }
-void Executor::exec_FSQ([[maybe_unused]] Instruction inst)
+void Executor::exec_FSQ([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FMADD_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FMADD_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(
+        inst.rd, inst.rm, [](float a, float b, float c) { return std::fma(a, b, c); },
+        readF<float>(inst.rs1), readF<float>(inst.rs2), readF<float>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FMSUB_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FMSUB_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(
+        inst.rd, inst.rm, [](float a, float b, float c) { return std::fma(a, b, -c); },
+        readF<float>(inst.rs1), readF<float>(inst.rs2), readF<float>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FNMSUB_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FNMSUB_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(
+        inst.rd, inst.rm, [](float a, float b, float c) { return std::fma(-a, b, c); },
+        readF<float>(inst.rs1), readF<float>(inst.rs2), readF<float>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FNMADD_S([[maybe_unused]] Instruction inst)
+void Executor::exec_FNMADD_S([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<float>(
+        inst.rd, inst.rm, [](float a, float b, float c) { return std::fma(-a, b, -c); },
+        readF<float>(inst.rs1), readF<float>(inst.rs2), readF<float>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FMADD_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FMADD_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(
+        inst.rd, inst.rm, [](double a, double b, double c) { return std::fma(a, b, c); },
+        readF<double>(inst.rs1), readF<double>(inst.rs2), readF<double>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FMSUB_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FMSUB_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(
+        inst.rd, inst.rm, [](double a, double b, double c) { return std::fma(a, b, -c); },
+        readF<double>(inst.rs1), readF<double>(inst.rs2), readF<double>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FNMSUB_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FNMSUB_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(
+        inst.rd, inst.rm, [](double a, double b, double c) { return std::fma(-a, b, c); },
+        readF<double>(inst.rs1), readF<double>(inst.rs2), readF<double>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FNMADD_D([[maybe_unused]] Instruction inst)
+void Executor::exec_FNMADD_D([[maybe_unused]] const Instruction &inst)
 {
-    std::abort();
+    execFloatOp<double>(
+        inst.rd, inst.rm, [](double a, double b, double c) { return std::fma(-a, b, -c); },
+        readF<double>(inst.rs1), readF<double>(inst.rs2), readF<double>(inst.rs3));
+    NEXT()
 }
-void Executor::exec_FMADD_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FMADD_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FMSUB_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FMSUB_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FNMSUB_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FNMSUB_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
-void Executor::exec_FNMADD_Q([[maybe_unused]] Instruction inst)
+void Executor::exec_FNMADD_Q([[maybe_unused]] const Instruction &inst)
 {
     std::abort();
 }
@@ -29,7 +29,13 @@ public:
             [[unlikely]] if (bb.add_instr(raw_instr) && ((opcode == 99) || (opcode == 103) || (opcode == 111)))
                 // jal jalr branches (end BB)
                 break;
+            // fence.i ends BB too, so translations are dropped before the next block runs
+            [[unlikely]] if (opcode == 15 && GetPartialBitsShifted<12, 14>(raw_instr) == 1)
+                break;
         }
+        // Stores to these pages invalidate the block
+        mmu_->MarkCodePage(uintptr_t(PC_));
+        mmu_->MarkCodePage(uintptr_t(PC_ + (bb.size() - 1) * 4));
     };
 
 private:
@@ -0,0 +1,86 @@
+#ifndef INTERPRETER_FPR_H
+#define INTERPRETER_FPR_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace simulator {
+
+using Register = uint64_t;
+
+const uint8_t FRegister_num = 32;
+
+// F and D registers share 64-bit storage, single precision values are NaN-boxed in it
+class FPR_file final {
+public:
+    enum Flags : uint8_t { NX = 1 << 0, UF = 1 << 1, OF = 1 << 2, DZ = 1 << 3, NV = 1 << 4, ALL_FLAGS = 0x1f };
+    enum RoundingMode : uint8_t { RNE = 0, RTZ = 1, RDN = 2, RUP = 3, RMM = 4, DYN = 7 };
+
+    static constexpr Register NAN_BOX = 0xffffffff00000000;
+    static constexpr uint32_t CANONICAL_NAN_S = 0x7fc00000;
+    static constexpr Register CANONICAL_NAN_D = 0x7ff8000000000000;
+
+    inline Register read(uint8_t reg_n) const
+    {
+        return fpr_[reg_n];
+    }
+    inline void write(uint8_t reg_n, Register value)
+    {
+        fpr_[reg_n] = value;
+    }
+    // Values which aren't properly NaN-boxed read as the canonical NaN
+    inline float readS(uint8_t reg_n) const
+    {
+        Register value = fpr_[reg_n];
+        return std::bit_cast<float>((value & NAN_BOX) == NAN_BOX ? static_cast<uint32_t>(value) : CANONICAL_NAN_S);
+    }
+    inline void writeS(uint8_t reg_n, float value)
+    {
+        fpr_[reg_n] = NAN_BOX | std::bit_cast<uint32_t>(value);
+    }
+    inline double readD(uint8_t reg_n) const
+    {
+        return std::bit_cast<double>(fpr_[reg_n]);
+    }
+    inline void writeD(uint8_t reg_n, double value)
+    {
+        fpr_[reg_n] = std::bit_cast<Register>(value);
+    }
+
+    inline uint8_t getFflags() const
+    {
+        return fflags_;
+    }
+    inline void setFflags(uint8_t flags)
+    {
+        fflags_ = flags & ALL_FLAGS;
+    }
+    inline void raise(uint8_t flags)
+    {
+        fflags_ |= flags;
+    }
+    inline uint8_t getFrm() const
+    {
+        return frm_;
+    }
+    inline void setFrm(uint8_t rm)
+    {
+        frm_ = rm & 0b111;
+    }
+
+    inline static auto getOffsetToStartOfRegisters()
+    {
+        return offsetof(FPR_file, fpr_);
+    }
+
+private:
+    std::array<Register, FRegister_num> fpr_ {};
+    uint8_t fflags_ = 0;
+    uint8_t frm_ = RNE;
+};
+
+}  // namespace simulator
+
+#endif  // INTERPRETER_FPR_H
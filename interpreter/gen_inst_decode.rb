@@ -74,30 +74,41 @@ class ISA
 		"#{string}ApplyMaskAndShift<#{mask}, #{bits.first['msb']}, #{bits.first['from']}>(raw_inst);\n"
 	end
 
-	def get_imm(field)
+	# CSR addresses are the only unsigned immediates
+	def signed_imm?(instruction)
+		!instruction['mnemonic'].start_with?('csr')
+	end
+
+	def get_imm(field, is_signed)
 		string = ''
 		location = field['location']
 		bits = location['bits']
 		names = ''
 		if bits.length == 1
 			chunk = bits.first
-			string += "\tinstr.#{field['name']} = "
-			string += "ApplyMaskAndShift<#{form_hex_mask(chunk)}, #{chunk['msb']}, #{chunk['from']}>(raw_inst);\n"
+			names = "ApplyMaskAndShift<#{form_hex_mask(chunk)}, #{chunk['msb']}, #{chunk['from']}>(raw_inst)"
 		else
 			bits.each do |chunk|
 				name = "#{field['name']}_#{chunk['from']}_#{chunk['to']}"
 				names += ' | ' unless names.empty?
 				names += name
-				string += "\t#{IMMEDIATE_TYPE} #{name} = "
+				string += "\tuint32_t #{name} = "
 				string += "ApplyMaskAndShift<#{form_hex_mask(chunk)}, #{chunk['msb']}, #{chunk['from']}>"
 				string += "(raw_inst);\n"
 			end
-			string += "\tinstr.#{field['name']} = (#{names});\n"
 		end
-		string
+		# The highest bit of the reassembled immediate is its sign
+		width = bits.map { |chunk| chunk['from'] }.max + 1
+		value = is_signed ? "GetSignedExtension<#{IMMEDIATE_TYPE}, #{width}>(#{names})" : names
+		string + "\tinstr.#{field['name']} = #{value};\n"
 	end
 
+	# Single special field (shift amount, aq/rl) is stored as a plain value, FENCE keeps its fields in place
 	def get_specials_in_imm(specials)
+		if specials.length == 1
+			chunk = specials.first['location']['bits'].first
+			return "\tinstr.imm = ApplyMaskAndShift<#{form_hex_mask(chunk)}, #{chunk['msb']}, #{chunk['from']}>(raw_inst);\n"
+		end
 		string = ''
 		names = ''
 		specials.each do |special_type|
@@ -106,7 +117,7 @@ class ISA
 			name = "#{special_type['name']}_#{bits.first['msb']}_#{bits.first['lsb']}"
 			names += ' | ' unless names.empty?
 			names += name
-			string += "\t#{IMMEDIATE_TYPE} #{name} = ApplyMask<uint32_t, #{form_hex_mask(bits.first)}>(raw_inst);\n"
+			string += "\tuint32_t #{name} = ApplyMask<uint32_t, #{form_hex_mask(bits.first)}>(raw_inst);\n"
 		end
 		string + "\tinstr.imm = (#{names});\n"
 	end
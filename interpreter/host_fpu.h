@@ -0,0 +1,178 @@
+#ifndef INTERPRETER_HOST_FPU_H
+#define INTERPRETER_HOST_FPU_H
+
+#include <immintrin.h>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "interpreter/fpr.h"
+
+namespace simulator::interpreter {
+
+// Guest arithmetic runs on host SSE. MXCSR.RC follows frm while guest code runs, so JIT code can use it for
+// dynamic rounding, and its exception flags collect what JIT code raised until the guest reads fflags
+constexpr uint32_t MXCSR_FLAGS = 0x3f;
+constexpr uint32_t MXCSR_RC_SHIFT = 13;
+constexpr uint32_t MXCSR_RC = 0b11 << MXCSR_RC_SHIFT;
+
+template <typename T>
+using FloatBits = std::conditional_t<std::is_same_v<T, float>, uint32_t, uint64_t>;
+
+// RMM has no SSE counterpart, it rounds ties to even instead of away from zero
+inline uint32_t GetHostRounding(uint8_t rm)
+{
+    switch (rm) {
+        case FPR_file::RTZ:
+            return 0b11 << MXCSR_RC_SHIFT;
+        case FPR_file::RDN:
+            return 0b01 << MXCSR_RC_SHIFT;
+        case FPR_file::RUP:
+            return 0b10 << MXCSR_RC_SHIFT;
+        default:
+            return 0;
+    }
+}
+
+// Denormal operand flag has no guest counterpart
+inline uint8_t GetGuestFlags(uint32_t mxcsr)
+{
+    uint8_t flags = 0;
+    flags |= (mxcsr & (1 << 0)) != 0 ? FPR_file::NV : 0;
+    flags |= (mxcsr & (1 << 2)) != 0 ? FPR_file::DZ : 0;
+    flags |= (mxcsr & (1 << 3)) != 0 ? FPR_file::OF : 0;
+    flags |= (mxcsr & (1 << 4)) != 0 ? FPR_file::UF : 0;
+    flags |= (mxcsr & (1 << 5)) != 0 ? FPR_file::NX : 0;
+    return flags;
+}
+
+// Keeps the compiler from moving arithmetic across MXCSR accesses
+template <typename T>
+inline T Opaque(T value)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        asm volatile("" : "+x"(value));
+    } else {
+        asm volatile("" : "+r"(value));
+    }
+    return value;
+}
+
+// Runs op(args...) with the given rounding and accrues the exceptions it raised into fflags
+template <typename Op, typename... Args>
+inline auto RunOnHostFPU(uint8_t rm, uint8_t &fflags, Op op, Args... args)
+{
+    uint32_t saved = _mm_getcsr();
+    _mm_setcsr((saved & ~(MXCSR_RC | MXCSR_FLAGS)) | GetHostRounding(rm));
+    auto result = Opaque(op(Opaque(args)...));
+    fflags |= GetGuestFlags(_mm_getcsr());
+    _mm_setcsr(saved);
+    return result;
+}
+
+template <typename T>
+inline T GetCanonicalNaN()
+{
+    if constexpr (std::is_same_v<T, float>) {
+        return std::bit_cast<float>(FPR_file::CANONICAL_NAN_S);
+    } else {
+        return std::bit_cast<double>(FPR_file::CANONICAL_NAN_D);
+    }
+}
+
+// Host NaNs keep their payloads, guest results carry the canonical NaN
+template <typename T>
+inline T Canonicalize(T value)
+{
+    return std::isnan(value) ? GetCanonicalNaN<T>() : value;
+}
+
+template <typename T>
+inline bool IsSignalingNaN(T value)
+{
+    constexpr FloatBits<T> QUIET_BIT = FloatBits<T>(1) << (std::numeric_limits<T>::digits - 2);
+    return std::isnan(value) && (std::bit_cast<FloatBits<T>>(value) & QUIET_BIT) == 0;
+}
+
+// FMIN/FMAX return the other operand for a single NaN and order -0 below +0
+template <typename T>
+inline T GetMinMax(T lhs, T rhs, bool is_max, uint8_t &fflags)
+{
+    if (IsSignalingNaN(lhs) || IsSignalingNaN(rhs))
+        fflags |= FPR_file::NV;
+    if (std::isnan(lhs) && std::isnan(rhs))
+        return GetCanonicalNaN<T>();
+    if (std::isnan(lhs))
+        return rhs;
+    if (std::isnan(rhs))
+        return lhs;
+    if (lhs == rhs)
+        return std::signbit(lhs) != is_max ? lhs : rhs;
+    return (lhs < rhs) != is_max ? lhs : rhs;
+}
+
+template <typename T>
+inline T RoundToIntegral(T value, uint8_t rm)
+{
+    if (std::isinf(value))
+        return value;
+    switch (rm) {
+        case FPR_file::RTZ:
+            return std::trunc(value);
+        case FPR_file::RDN:
+            return std::floor(value);
+        case FPR_file::RUP:
+            return std::ceil(value);
+        case FPR_file::RMM:
+            return std::round(value);
+        default:
+            // remainder() rounds the quotient to nearest even
+            return value - std::remainder(value, T(1));
+    }
+}
+
+// Out of range values and NaNs saturate and raise NV instead of producing the x86 integer indefinite
+template <typename Int, typename T>
+inline Int ConvertToInt(T value, uint8_t rm, uint8_t &fflags)
+{
+    if (std::isnan(value)) {
+        fflags |= FPR_file::NV;
+        return std::numeric_limits<Int>::max();
+    }
+    T rounded = RoundToIntegral(value, rm);
+    T limit = std::ldexp(T(1), std::numeric_limits<Int>::digits);
+    if (rounded >= limit) {
+        fflags |= FPR_file::NV;
+        return std::numeric_limits<Int>::max();
+    }
+    if (std::is_signed_v<Int> ? rounded < -limit : rounded < 0) {
+        fflags |= FPR_file::NV;
+        return std::numeric_limits<Int>::min();
+    }
+    if (rounded != value)
+        fflags |= FPR_file::NX;
+    return static_cast<Int>(rounded);
+}
+
+template <typename T>
+inline Register Classify(T value)
+{
+    bool is_negative = std::signbit(value);
+    switch (std::fpclassify(value)) {
+        case FP_INFINITE:
+            return is_negative ? 1 << 0 : 1 << 7;
+        case FP_NORMAL:
+            return is_negative ? 1 << 1 : 1 << 6;
+        case FP_SUBNORMAL:
+            return is_negative ? 1 << 2 : 1 << 5;
+        case FP_ZERO:
+            return is_negative ? 1 << 3 : 1 << 4;
+        default:
+            return IsSignalingNaN(value) ? 1 << 8 : 1 << 9;
+    }
+}
+
+}  // namespace simulator::interpreter
+
+#endif  // INTERPRETER_HOST_FPU_H
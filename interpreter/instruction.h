@@ -8,28 +8,31 @@
 namespace simulator {
 
 using Register_t = uint8_t;
-using Immediate_t = uint32_t;
+using Immediate_t = int64_t;
 using Opcode_t = uint8_t;
 
 constexpr uint32_t OPCODE_MASK = 0x0000007f;
 
-class Instruction final {
+// Decoded once and executed many times, so operands are stored ready to use. Two instructions share a cache line
+class alignas(32) Instruction final {
 public:
-    Immediate_t GetShamt() const
-    {
-        return ApplyMaskAndShift<0x03f00000, 20, 0>(imm);
-    }
     Register_t rs1 = 0;
     Register_t rs2 = 0;
     Register_t rs3 = 0;
     Register_t rd = 0;
     Register_t rm = 0;
+    // Sign-extended to 64 bits, branch and jump offsets are in bytes, LUI/AUIPC values are already shifted.
+    // Shifts keep the shift amount here, CSR instructions the zero-extended CSR address
     Immediate_t imm = 0;
 
     Opcode_t opcode = 0;
     InstructionId inst_id = WRONG_INST;
+    // Label of the threaded interpreter running inst_id, set for instructions of decoded blocks
+    const void *handler = nullptr;
 };
 
+static_assert(sizeof(Instruction) == 32);
+
 }  // namespace simulator
 
 #endif  // INTERPRETER_INSTRS_H
\ No newline at end of file
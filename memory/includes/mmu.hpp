@@ -4,6 +4,10 @@
 #include <gelf.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include "phys_mem.hpp"
 
 namespace simulator::mem {
@@ -11,7 +15,20 @@ namespace simulator::mem {
 class MMU final {
 public:
     static constexpr size_t PTE_SIZE = 8;
-    static constexpr size_t TLB_SIZE = 4096;
+    static constexpr size_t TLB_SIZE = 4096;  // must be a power of 2
+    // Page aligned addresses never match it
+    static constexpr uintptr_t TLB_INVALID_TAG = 1;
+
+    // paddr is an offset of the page in physical memory, vaddr is a virtual address without page offset
+    struct TlbEntry {
+        int64_t paddr;
+        uintptr_t vaddr;
+    };
+    struct Symbol {
+        uintptr_t addr;
+        uint64_t size;
+        std::string name;
+    };
     NO_COPY_SEMANTIC(MMU)
     NO_MOVE_SEMANTIC(MMU)
 
@@ -28,6 +45,52 @@ public:
     void StoreEightBytesFast(uintptr_t addr, uint64_t value);
     uint64_t LoadEightBytesFast(uintptr_t addr);
     [[nodiscard]] uintptr_t StoreElfFile(const std::string &name);
+    // Hash of the loaded segments, identifies the binary for caches which outlive a run
+    inline uint64_t GetElfHash() const
+    {
+        return elf_hash_;
+    }
+    // Executable segments as [begin, end), used to discover code before running it
+    inline const std::vector<std::pair<uintptr_t, uintptr_t>> &GetCodeSegments() const
+    {
+        return code_segments_;
+    }
+    // Addresses of function symbols, empty for stripped binaries
+    inline const std::vector<uintptr_t> &GetFunctionAddrs() const
+    {
+        return function_addrs_;
+    }
+    // Function symbol whose body contains vaddr, nullptr if there's none
+    const Symbol *FindFunctionSymbol(uintptr_t vaddr) const;
+    uint8_t *GetPhysAddrWithAllocation(uintptr_t vaddr);
+    // Stores to code pages are recorded, so the hart can drop translations made from them
+    uint8_t *GetPhysAddrForStore(uintptr_t vaddr);
+
+    // Called for every fetched block, code pages are kept out of the store TLB
+    void MarkCodePage(uintptr_t vaddr);
+    // FENCE.I: every translation has to be dropped before the next fetch
+    void FlushCodePages();
+    inline bool HasCodeWrites() const
+    {
+        return !written_code_pages_.empty();
+    }
+    // Code pages written since the last call, they are no longer tracked
+    std::vector<uintptr_t> TakeCodeWrites();
+
+    // Used by JIT to inline TLB lookup
+    inline const TlbEntry *GetTlb() const
+    {
+        return tlb_.data();
+    }
+    // Same layout as the TLB, but pages holding code never get there
+    inline const TlbEntry *GetStoreTlb() const
+    {
+        return store_tlb_.data();
+    }
+    inline uint8_t *GetMemPointer() const
+    {
+        return ram_->GetMemPointer();
+    }
 
 private:
     MMU();
@@ -37,13 +100,21 @@ private:
     uint64_t PageLookUp(uint32_t vpn0, uint32_t vpn1, uint32_t vpn2, uint32_t vpn3);
     inline uintptr_t CheckInTlb(int64_t id, uintptr_t vaddr);
     inline void PushToTlb(int64_t vpn0, uintptr_t vaddr, uintptr_t paddr);
-    uint8_t *GetPhysAddrWithAllocation(uintptr_t vaddr);
     inline bool IsVirtAddrCanonical(uintptr_t vaddr) const;
     uintptr_t GetPointer(uint64_t page_id, uint64_t page_offset) const;
     void ValidateElfHeader(const GElf_Ehdr &ehdr) const;
+    void LoadFunctionSymbols(Elf *e);
 
-    std::vector<std::pair<int64_t, uintptr_t>> tlb_;
+    std::vector<TlbEntry> tlb_;
+    std::vector<TlbEntry> store_tlb_;
+    std::unordered_set<uintptr_t> code_pages_;
+    std::vector<uintptr_t> written_code_pages_;
     PhysMem *ram_ = nullptr;
+    uint64_t elf_hash_ = 0;
+    std::vector<std::pair<uintptr_t, uintptr_t>> code_segments_;
+    std::vector<uintptr_t> function_addrs_;
+    // Sorted by address
+    std::vector<Symbol> function_symbols_;
 };
 }  // namespace simulator::mem
 
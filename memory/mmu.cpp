@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include "bitops.h"
 #include "mmu.hpp"
@@ -6,7 +7,8 @@ namespace simulator::mem {
 MMU::MMU()
 {
     ram_ = PhysMem::CreatePhysMem(1_GB);
-    tlb_.resize(TLB_SIZE, {-1, 0});
+    tlb_.resize(TLB_SIZE, {-1, TLB_INVALID_TAG});
+    store_tlb_.resize(TLB_SIZE, {-1, TLB_INVALID_TAG});
     assert(ram_ != nullptr);
 }
 
@@ -36,7 +38,7 @@ void MMU::StoreByte(uintptr_t addr, uint8_t chr)
     // TODO(Mirageinvo): maybe create derived page_fault exception class?
     // handling possible page fault exception
     try {
-        phys_addr = GetPhysAddrWithAllocation(addr);
+        phys_addr = GetPhysAddrForStore(addr);
     } catch (const std::runtime_error &e) {
         std::cerr << e.what();
         PhysMem::Destroy(ram_);
@@ -129,10 +131,10 @@ uint64_t MMU::PageLookUp(uint32_t vpn0, uint32_t vpn1, uint32_t vpn2, uint32_t v
 uintptr_t MMU::CheckInTlb(int64_t id, uintptr_t vaddr)
 {
     id = id % TLB_SIZE;
-    auto pair = tlb_[id];
-    [[likely]] if (pair.first != -1 && pair.second == vaddr)
+    auto entry = tlb_[id];
+    [[likely]] if (entry.paddr != -1 && entry.vaddr == vaddr)
     {
-        return pair.first;
+        return entry.paddr;
     }
     return 0;
 }
@@ -140,7 +142,7 @@ uintptr_t MMU::CheckInTlb(int64_t id, uintptr_t vaddr)
 void MMU::PushToTlb(int64_t id, uintptr_t vaddr, uintptr_t paddr)
 {
     id = id % TLB_SIZE;
-    tlb_[id] = std::make_pair(paddr, vaddr);
+    tlb_[id] = {static_cast<int64_t>(paddr), vaddr};
 }
 
 uint8_t *MMU::GetPhysAddrWithAllocation(uintptr_t vaddr)
@@ -152,7 +154,8 @@ uint8_t *MMU::GetPhysAddrWithAllocation(uintptr_t vaddr)
     }
 
     uint32_t vpn0 = GetPartialBitsShifted<12, 20>(vaddr);
-    uint64_t tlb_ind = vpn0;
+    // The whole virtual page number is used, so that JIT can compute the index with a single shift
+    uint64_t tlb_ind = vaddr >> Page::OFFSET_BIT_LENGTH;
     uint64_t vaddr_without_offset = RemoveOffset(vaddr);
     uintptr_t paddr = CheckInTlb(tlb_ind, vaddr_without_offset);
     [[unlikely]] if (paddr == 0)
@@ -168,6 +171,47 @@ uint8_t *MMU::GetPhysAddrWithAllocation(uintptr_t vaddr)
     return ToNativePtr<uint8_t>(ToUintPtr<uint8_t>(ram_->GetMemPointer()) + paddr);
 }
 
+uint8_t *MMU::GetPhysAddrForStore(uintptr_t vaddr)
+{
+    auto &entry = store_tlb_[(vaddr >> Page::OFFSET_BIT_LENGTH) % TLB_SIZE];
+    [[likely]] if (entry.vaddr == RemoveOffset(vaddr))
+    {
+        return ram_->GetMemPointer() + entry.paddr + GetPageOffsetByAddress(vaddr);
+    }
+
+    uint8_t *phys_addr = GetPhysAddrWithAllocation(vaddr);
+    [[unlikely]] if (code_pages_.erase(RemoveOffset(vaddr)) != 0)
+    {
+        written_code_pages_.push_back(RemoveOffset(vaddr));
+        return phys_addr;
+    }
+    auto paddr = phys_addr - ram_->GetMemPointer() - GetPageOffsetByAddress(vaddr);
+    entry = {static_cast<int64_t>(paddr), RemoveOffset(vaddr)};
+    return phys_addr;
+}
+
+void MMU::MarkCodePage(uintptr_t vaddr)
+{
+    [[likely]] if (!code_pages_.insert(RemoveOffset(vaddr)).second)
+        return;
+    auto &entry = store_tlb_[(vaddr >> Page::OFFSET_BIT_LENGTH) % TLB_SIZE];
+    if (entry.vaddr == RemoveOffset(vaddr))
+        entry = {-1, TLB_INVALID_TAG};
+}
+
+void MMU::FlushCodePages()
+{
+    written_code_pages_.insert(written_code_pages_.end(), code_pages_.begin(), code_pages_.end());
+    code_pages_.clear();
+}
+
+std::vector<uintptr_t> MMU::TakeCodeWrites()
+{
+    std::vector<uintptr_t> pages;
+    pages.swap(written_code_pages_);
+    return pages;
+}
+
 bool MMU::IsVirtAddrCanonical(uintptr_t vaddr) const
 {
     static constexpr uint64_t ADDRESS_UPPER_BITS_MASK_SV48 = 0xFFFF800000000000;
@@ -191,7 +235,7 @@ uint64_t MMU::RemoveOffset(uintptr_t addr) const
 void MMU::StoreTwoBytesFast(uintptr_t addr, uint16_t value)
 {
     assert(ram_->AtOnePage(GetPageOffsetByAddress(addr), 2));
-    *reinterpret_cast<uint16_t *>(GetPhysAddrWithAllocation(addr)) = value;
+    *reinterpret_cast<uint16_t *>(GetPhysAddrForStore(addr)) = value;
 }
 
 uint16_t MMU::LoadTwoBytesFast(uintptr_t addr)
@@ -203,7 +247,7 @@ uint16_t MMU::LoadTwoBytesFast(uintptr_t addr)
 void MMU::StoreFourBytesFast(uintptr_t addr, uint32_t value)
 {
     assert(ram_->AtOnePage(GetPageOffsetByAddress(addr), 4));
-    *reinterpret_cast<uint32_t *>(GetPhysAddrWithAllocation(addr)) = value;
+    *reinterpret_cast<uint32_t *>(GetPhysAddrForStore(addr)) = value;
 }
 
 uint32_t MMU::LoadFourBytesFast(uintptr_t addr)
@@ -215,7 +259,7 @@ uint32_t MMU::LoadFourBytesFast(uintptr_t addr)
 void MMU::StoreEightBytesFast(uintptr_t addr, uint64_t value)
 {
     assert(ram_->AtOnePage(GetPageOffsetByAddress(addr), 8));
-    *reinterpret_cast<uint64_t *>(GetPhysAddrWithAllocation(addr)) = value;
+    *reinterpret_cast<uint64_t *>(GetPhysAddrForStore(addr)) = value;
 }
 
 uint64_t MMU::LoadEightBytesFast(uintptr_t addr)
@@ -224,6 +268,16 @@ uint64_t MMU::LoadEightBytesFast(uintptr_t addr)
     return *reinterpret_cast<uint64_t *>(GetPhysAddrWithAllocation(addr));
 }
 
+// FNV-1a
+static uint64_t HashBytes(uint64_t hash, const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
 uintptr_t MMU::StoreElfFile(const std::string &name)
 {
     int fd;
@@ -248,6 +302,7 @@ uintptr_t MMU::StoreElfFile(const std::string &name)
 
     GElf_Phdr phdr;
     std::vector<uint8_t> buff;
+    elf_hash_ = 0xcbf29ce484222325;
     for (size_t i = 0; i < n; ++i) {
         if (gelf_getphdr(e, i, &phdr) != &phdr)
             throw std::runtime_error("gelf_getphdr() failed: " + std::string(elf_errmsg(-1)));
@@ -262,7 +317,12 @@ uintptr_t MMU::StoreElfFile(const std::string &name)
             std::abort();
         }
         StoreByteSequence(phdr.p_vaddr, buff.data(), phdr.p_filesz);
+        elf_hash_ = HashBytes(elf_hash_, reinterpret_cast<const uint8_t *>(&phdr.p_vaddr), sizeof(phdr.p_vaddr));
+        elf_hash_ = HashBytes(elf_hash_, buff.data(), phdr.p_filesz);
+        if ((phdr.p_flags & PF_X) != 0)
+            code_segments_.emplace_back(phdr.p_vaddr, phdr.p_vaddr + phdr.p_filesz);
     }
+    LoadFunctionSymbols(e);
 
     elf_end(e);
     close(fd);
@@ -270,6 +330,41 @@ uintptr_t MMU::StoreElfFile(const std::string &name)
     return ehdr.e_entry;
 }
 
+void MMU::LoadFunctionSymbols(Elf *e)
+{
+    Elf_Scn *scn = nullptr;
+    while ((scn = elf_nextscn(e, scn)) != nullptr) {
+        GElf_Shdr shdr;
+        if (gelf_getshdr(scn, &shdr) != &shdr || shdr.sh_type != SHT_SYMTAB || shdr.sh_entsize == 0)
+            continue;
+        Elf_Data *data = elf_getdata(scn, nullptr);
+        if (data == nullptr)
+            continue;
+        for (size_t i = 0; i < shdr.sh_size / shdr.sh_entsize; ++i) {
+            GElf_Sym sym;
+            if (gelf_getsym(data, i, &sym) != &sym || GELF_ST_TYPE(sym.st_info) != STT_FUNC || sym.st_value == 0)
+                continue;
+            function_addrs_.push_back(sym.st_value);
+            const char *name = elf_strptr(e, shdr.sh_link, sym.st_name);
+            if (name != nullptr)
+                function_symbols_.push_back({sym.st_value, sym.st_size, name});
+        }
+    }
+    std::sort(function_symbols_.begin(), function_symbols_.end(),
+              [](const Symbol &lhs, const Symbol &rhs) { return lhs.addr < rhs.addr; });
+}
+
+const MMU::Symbol *MMU::FindFunctionSymbol(uintptr_t vaddr) const
+{
+    auto it = std::upper_bound(function_symbols_.begin(), function_symbols_.end(), vaddr,
+                               [](uintptr_t addr, const Symbol &sym) { return addr < sym.addr; });
+    if (it == function_symbols_.begin())
+        return nullptr;
+    --it;
+    // Symbols without a size only cover their first instruction
+    return vaddr < it->addr + std::max<uint64_t>(it->size, 4) ? &*it : nullptr;
+}
+
 void MMU::ValidateElfHeader(const GElf_Ehdr &ehdr) const
 {
 #define checkHeaderField(offset, value) \
@@ -0,0 +1,123 @@
+#ifndef SIMULATOR_BB_CACHE_H
+#define SIMULATOR_BB_CACHE_H
+
+#include "macros.hpp"
+#include "interpreter/BB.h"
+#include "interpreter/gpr.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace simulator::core {
+
+// Set-associative cache of decoded blocks with LRU replacement inside a set. Compiled code and chain slots
+// point to the blocks, so they never move: entries are allocated once and only reused for other PCs
+class BBCache final {
+public:
+    // PC 0 ends the simulation, so it marks free entries
+    using Entry = std::pair<Register, interpreter::DecodedBB>;
+
+    static constexpr size_t WAYS = 4;
+    static constexpr size_t MIN_SIZE = 256;
+    static constexpr size_t MAX_SIZE = 1 << 16;
+
+    explicit BBCache(size_t size = MIN_SIZE)
+    {
+        resize(size);
+    }
+    NO_COPY_SEMANTIC(BBCache)
+    NO_MOVE_SEMANTIC(BBCache)
+
+    // Roughly one block per four instructions of text, rounded up to a power of 2
+    static size_t GetSizeFor(size_t text_bytes)
+    {
+        size_t size = MIN_SIZE;
+        while (size < MAX_SIZE && size * 4 * sizeof(uint32_t) < text_bytes)
+            size *= 2;
+        return size;
+    }
+
+    // Drops every block, so it must happen before anything refers to them
+    void resize(size_t size)
+    {
+        size = std::clamp(size, MIN_SIZE, MAX_SIZE);
+        set_bits_ = 0;
+        while ((WAYS << set_bits_) < size)
+            ++set_bits_;
+        entries_ = std::vector<Entry>(WAYS << set_bits_);
+        last_use_.assign(entries_.size(), 0);
+    }
+    inline size_t size() const
+    {
+        return entries_.size();
+    }
+
+    // Entry holding pc, or the one pc has to replace: a free way or the least recently used one
+    Entry &lookup(Register pc)
+    {
+        auto first = getSet(pc);
+        auto victim = first;
+        for (auto way = first; way < first + WAYS; ++way) {
+            if (entries_[way].first == pc) {
+                victim = way;
+                break;
+            }
+            bool is_older = entries_[way].first == 0 || last_use_[way] < last_use_[victim];
+            if (entries_[victim].first != 0 && is_older)
+                victim = way;
+        }
+        last_use_[victim] = ++clock_;
+        return entries_[victim];
+    }
+    // Entry holding pc or nullptr, recency isn't updated
+    Entry *find(Register pc)
+    {
+        auto first = getSet(pc);
+        for (auto way = first; way < first + WAYS; ++way) {
+            if (entries_[way].first == pc)
+                return &entries_[way];
+        }
+        return nullptr;
+    }
+    // Entry which pc can take without replacing another block
+    Entry *findFree(Register pc)
+    {
+        auto first = getSet(pc);
+        for (auto way = first; way < first + WAYS; ++way) {
+            if (entries_[way].first == 0) {
+                last_use_[way] = ++clock_;
+                return &entries_[way];
+            }
+        }
+        return nullptr;
+    }
+
+    inline auto begin()
+    {
+        return entries_.begin();
+    }
+    inline auto end()
+    {
+        return entries_.end();
+    }
+
+private:
+    // Fibonacci hashing spreads the strided PCs of small functions over all sets
+    inline size_t getSet(Register pc) const
+    {
+        constexpr uint64_t GOLDEN_RATIO = 0x9e3779b97f4a7c15;
+        return static_cast<size_t>(((pc >> 2) * GOLDEN_RATIO) >> (64 - set_bits_)) * WAYS;
+    }
+
+    std::vector<Entry> entries_;
+    // Logical time of the last lookup of every entry
+    std::vector<uint64_t> last_use_;
+    uint64_t clock_ = 0;
+    size_t set_bits_ = 0;
+};
+
+}  // namespace simulator::core
+
+#endif  // SIMULATOR_BB_CACHE_H
@@ -1,15 +1,20 @@
 #ifndef INTERPRETER_HART_H
 #define INTERPRETER_HART_H
 
-#include "compiler/compiler.hpp"
+#include "compiler/compile_queue.hpp"
 #include "macros.hpp"
 #include "mmu.hpp"
 #include "interpreter/fetch.h"
 #include "interpreter/decoder.h"
 #include "interpreter/executor.h"
 #include "interpreter/BB.h"
+#include "bb_cache.h"
+#include "trace_cache.h"
 #include <array>
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace simulator::core {
 
@@ -18,21 +23,62 @@ public:
     enum class Mode { NONE, SIMPLE, BB };
 
     void RunImpl(Mode mode, bool need_to_measure);
+    // Traces from previous runs of the binary are compiled at startup, new ones are saved at exit
+    void UseTraceCache(const std::string &dir);
+    // Blocks reachable from the entry point and function symbols get baseline code before the run starts
+    void UseStaticTranslation();
+    // Runs of a block before it gets baseline code, and before a trace starting at it gets optimized
+    void SetTierThresholds(size_t baseline, size_t optimize);
+    // Decoded blocks kept at once, rounded up to a power of 2. Sized from the ELF text by default
+    void SetBBCacheSize(size_t blocks);
+    // Bytes of JIT code kept at once, the oldest blocks are evicted past it
+    void SetCodeCacheLimit(size_t bytes);
+    // Compiled blocks get named by guest PC and function symbol for perf and GDB
+    void UseJitDebugInfo(bool perf_map, bool gdb);
+    // Also times the interpreter and compiled code, which costs a clock read per dispatch
+    void CollectStats();
+    compiler::JitStats GetStats() const;
 
     Hart(mem::MMU *mmu, uintptr_t entry_point, bool is_cosim)
-        : mmu_(mmu), fetch_(mmu), executor_(mmu_, entry_point, is_cosim), is_cosim_(is_cosim) {};
+        : mmu_(mmu),
+          compile_queue_(mmu, is_cosim),
+          fetch_(mmu),
+          executor_(mmu_, entry_point, is_cosim),
+          bb_cache_(BBCache::GetSizeFor(GetTextSize(mmu))) {};
     NO_COPY_SEMANTIC(Hart)
     NO_MOVE_SEMANTIC(Hart)
 
 private:
+    static size_t GetTextSize(const mem::MMU *mmu);
+    // Returns the last executed block
+    interpreter::DecodedBB *RunCompiled(interpreter::DecodedBB *bb, size_t &counter);
+    // Queues the recorded trace for compilation into its head block
+    void FinishTrace();
+    // Drops decoded blocks and compiled code made from the written pages
+    void InvalidateCode(const std::vector<uintptr_t> &pages);
+    // Moves the bodies of cached blocks into a fresh arena, dropping the ones of replaced blocks
+    void CompactArena();
+    void TranslateAhead();
+    void PreloadTraces();
+    void SaveTraces();
+
     mem::MMU *mmu_;
-    compiler::Compiler compiler_;
+    compiler::CompileQueue compile_queue_;
     interpreter::Fetch fetch_;
     interpreter::Decoder decoder_;
     interpreter::Executor executor_;
-    static constexpr size_t BB_CACHE_SIZE = 256;
-    std::array<std::pair<Register, interpreter::DecodedBB>, BB_CACHE_SIZE> bb_cache_;
-    bool is_cosim_;
+    interpreter::BBArena bb_arena_;
+    BBCache bb_cache_;
+    bool is_aot_ = false;
+    bool is_timing_ = false;
+    compiler::JitStats::Dispatch dispatch_stats_;
+    size_t baseline_threshold_ = 10;
+    size_t optimize_threshold_ = 1000;
+    // Blocks executed after a hot block are recorded and compiled together with it
+    interpreter::Trace trace_;
+    Register trace_head_ = 0;
+    bool is_recording_ = false;
+    std::unique_ptr<TraceCache> trace_cache_;
 };
 
 }  // namespace simulator::core
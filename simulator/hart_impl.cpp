@@ -1,12 +1,240 @@
 #include "hart.h"
 #include "interpreter/gpr.h"
-#include "compiler/compiler.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <unordered_set>
+#include <utility>
 
 namespace simulator::core {
 
+size_t Hart::GetTextSize(const mem::MMU *mmu)
+{
+    size_t size = 0;
+    for (auto &&[begin, end] : mmu->GetCodeSegments())
+        size += end - begin;
+    return size;
+}
+
+interpreter::DecodedBB *Hart::RunCompiled(interpreter::DecodedBB *bb, size_t &counter)
+{
+    auto start = is_timing_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point {};
+    // Follow patched chain slots until some block exits to a successor which isn't linked yet
+    for (;;) {
+        auto *next = bb->getCompiledEntry()(&executor_, bb->getTrace().instrs.data());
+        [[unlikely]] if (next == nullptr)
+        {
+            // Every exit taken on the way has added the instructions it retired
+            counter += executor_.takeCompiledInstrs();
+            if (is_timing_)
+                dispatch_stats_.compiled_time += std::chrono::steady_clock::now() - start;
+            return bb;
+        }
+        bb = next;
+    }
+}
+
+void Hart::FinishTrace()
+{
+    is_recording_ = false;
+    auto *head = bb_cache_.find(trace_head_);
+    // Head could have been evicted while the trace was recorded
+    if (head != nullptr && !trace_.instrs.empty()) {
+        compile_queue_.push(&head->second, std::move(trace_));
+    }
+    trace_.clear();
+}
+
+void Hart::InvalidateCode(const std::vector<uintptr_t> &pages)
+{
+    auto is_written = [&pages](Register pc) {
+        return std::find(pages.begin(), pages.end(), pc & mem::Page::ID_MASK) != pages.end();
+    };
+    for (auto &&[addr, decodedBB] : bb_cache_) {
+        if (addr == 0)
+            continue;
+        // Blocks end before a page boundary is crossed twice, so checking both ends is enough
+        bool is_body_stale = is_written(addr) || is_written(addr + (decodedBB.size() - 1) * 4);
+        const auto &pcs = decodedBB.getTrace().pcs;
+        if (is_body_stale || std::any_of(pcs.begin(), pcs.end(), is_written))
+            compile_queue_.evict(&decodedBB);
+        // PC 0 ends the simulation, so it's never looked up
+        if (is_body_stale)
+            addr = 0;
+    }
+    compile_queue_.dropPending();
+    is_recording_ = false;
+    trace_.clear();
+}
+
+void Hart::CompactArena()
+{
+    // Nothing but the blocks refers to their bodies: traces and compiled code keep copies
+    interpreter::BBArena arena;
+    for (auto &&[addr, decodedBB] : bb_cache_) {
+        if (addr != 0) {
+            decodedBB.moveBody(arena);
+        } else {
+            decodedBB.dropBody();
+        }
+    }
+    bb_arena_ = std::move(arena);
+}
+
+void Hart::UseTraceCache(const std::string &dir)
+{
+    trace_cache_ = std::make_unique<TraceCache>(dir, mmu_->GetElfHash());
+    trace_cache_->Load();
+}
+
+void Hart::UseStaticTranslation()
+{
+    is_aot_ = true;
+}
+
+void Hart::TranslateAhead()
+{
+    const auto &segments = mmu_->GetCodeSegments();
+    auto is_code = [&segments](Register pc) {
+        return std::any_of(segments.begin(), segments.end(),
+                           [pc](const auto &segment) { return pc >= segment.first && pc + 4 <= segment.second; });
+    };
+
+    std::vector<Register> worklist(mmu_->GetFunctionAddrs().begin(), mmu_->GetFunctionAddrs().end());
+    worklist.push_back(executor_.getPC());
+    std::unordered_set<Register> visited;
+    std::vector<std::pair<Register, interpreter::DecodedBB *>> translated;
+    interpreter::BB raw_bb;
+    // Blocks whose set is full are decoded here only to follow their successors
+    interpreter::DecodedBB scratch;
+    while (!worklist.empty()) {
+        auto pc = worklist.back();
+        worklist.pop_back();
+        if (pc % 4 != 0 || !is_code(pc) || !visited.insert(pc).second)
+            continue;
+
+        auto *entry = bb_cache_.findFree(pc);
+        auto &decodedBB = entry != nullptr ? entry->second : scratch;
+        fetch_.loadBB(pc, raw_bb);
+        decoder_.DecodeBB(raw_bb, decodedBB, bb_arena_);
+        if (entry != nullptr) {
+            compile_queue_.evict(&decodedBB);
+            entry->first = pc;
+            translated.emplace_back(pc, &decodedBB);
+        }
+
+        // Targets of indirect jumps are left to the dispatcher
+        auto last_pc = pc + (decodedBB.size() - 1) * 4;
+        const auto &last = decodedBB.getBody()[decodedBB.size() - 1];
+        switch (last.inst_id) {
+            case InstructionId::BEQ:
+            case InstructionId::BNE:
+            case InstructionId::BLT:
+            case InstructionId::BGE:
+            case InstructionId::BLTU:
+            case InstructionId::BGEU:
+                worklist.push_back(last_pc + last.imm);
+                worklist.push_back(last_pc + 4);
+                break;
+            case InstructionId::JAL:
+                worklist.push_back(last_pc + last.imm);
+                // Calls come back right after themselves
+                if (last.rd != GPR_file::X0)
+                    worklist.push_back(last_pc + 4);
+                break;
+            case InstructionId::JALR:
+                if (last.rd != GPR_file::X0)
+                    worklist.push_back(last_pc + 4);
+                break;
+            default:
+                worklist.push_back(last_pc + 4);
+                break;
+        }
+    }
+    scratch.releaseBody(bb_arena_);
+
+    for (auto &&[pc, decodedBB] : translated)
+        compile_queue_.compileBaseline(decodedBB, pc, optimize_threshold_);
+    // Whole program is known, so direct exits are chained before anything runs
+    for (auto &&[pc, decodedBB] : translated) {
+        for (auto succ_pc : decodedBB->getSuccessorPcs()) {
+            auto *target = bb_cache_.find(succ_pc);
+            if (target != nullptr && target->second.getCompileStatus() != interpreter::DecodedBB::CompileStatus::RAW)
+                decodedBB->link(succ_pc, &target->second);
+        }
+    }
+}
+
+void Hart::SetTierThresholds(size_t baseline, size_t optimize)
+{
+    baseline_threshold_ = std::max<size_t>(baseline, 1);
+    // Baseline code checks for the exact count, so it has to be reachable after the baseline threshold
+    optimize_threshold_ = std::max(optimize, baseline_threshold_ + 1);
+}
+
+void Hart::SetBBCacheSize(size_t blocks)
+{
+    bb_cache_.resize(blocks);
+}
+
+void Hart::SetCodeCacheLimit(size_t bytes)
+{
+    compile_queue_.setCodeLimit(bytes);
+}
+
+void Hart::CollectStats()
+{
+    is_timing_ = true;
+}
+
+compiler::JitStats Hart::GetStats() const
+{
+    auto stats = compile_queue_.getStats();
+    stats.dispatch = dispatch_stats_;
+    return stats;
+}
+
+void Hart::UseJitDebugInfo(bool perf_map, bool gdb)
+{
+    if (perf_map)
+        compile_queue_.getDebugInfo().enablePerfMap();
+    if (gdb)
+        compile_queue_.getDebugInfo().enableGdb();
+}
+
+void Hart::PreloadTraces()
+{
+    interpreter::BB raw_bb;
+    interpreter::DecodedBB decodedBB;
+    for (auto &&[head_pc, path] : trace_cache_->GetPaths()) {
+        for (auto pc : path) {
+            fetch_.loadBB(pc, raw_bb);
+            decoder_.DecodeBB(raw_bb, decodedBB, bb_arena_);
+            trace_.append(decodedBB.getRawData(), decodedBB.size(), pc);
+        }
+        auto &&[addr, head] = bb_cache_.lookup(head_pc);
+        if (addr != head_pc) {
+            compile_queue_.evict(&head);
+            fetch_.loadBB(head_pc, raw_bb);
+            decoder_.DecodeBB(raw_bb, head, bb_arena_);
+            addr = head_pc;
+        }
+        trace_head_ = head_pc;
+        FinishTrace();
+    }
+    decodedBB.releaseBody(bb_arena_);
+}
+
+void Hart::SaveTraces()
+{
+    for (auto &&[addr, decodedBB] : bb_cache_) {
+        if (decodedBB.getCompileStatus() == interpreter::DecodedBB::CompileStatus::OPTIMIZED)
+            trace_cache_->Update(decodedBB.getTrace().block_pcs);
+    }
+    trace_cache_->Save();
+}
+
 void Hart::RunImpl(Mode mode, bool need_to_measure)
 {
     size_t counter = 0;
@@ -22,36 +250,99 @@ void Hart::RunImpl(Mode mode, bool need_to_measure)
                 ++counter;
             } while (executor_.getPC() != 0);
 
+            dispatch_stats_.interpreted_instrs = counter;
+
             break;
         }
         case Mode::BB: {
             interpreter::BB raw_bb;
-            Register cache_addr;
+            // Last compiled block that left through an unpatched chain slot
+            interpreter::DecodedBB *prev_bb = nullptr;
+            if (is_aot_)
+                TranslateAhead();
+            if (trace_cache_)
+                PreloadTraces();
             do {
-                cache_addr = executor_.getPC() / 4 % BB_CACHE_SIZE;
-                auto &&[addr, decodedBB] = bb_cache_[cache_addr];
+                // Stores to code pages are handled between blocks, guest code has to run FENCE.I before
+                // executing what it wrote anyway, and FENCE.I always returns here
+                [[unlikely]] if (mmu_->HasCodeWrites())
+                {
+                    InvalidateCode(mmu_->TakeCodeWrites());
+                    prev_bb = nullptr;
+                }
+                compile_queue_.publish();
+                auto &&[addr, decodedBB] = bb_cache_.lookup(executor_.getPC());
                 [[unlikely]] if (addr != executor_.getPC())
                 {
+                    ++(addr == 0 ? dispatch_stats_.bb_cache_misses : dispatch_stats_.bb_cache_conflicts);
+                    if (bb_arena_.isFragmented())
+                        CompactArena();
+                    compile_queue_.evict(&decodedBB);
                     fetch_.loadBB(executor_.getPC(), raw_bb);
-                    decoder_.DecodeBB(raw_bb, decodedBB);
+                    decoder_.DecodeBB(raw_bb, decodedBB, bb_arena_);
                     addr = executor_.getPC();
-                }
-                if (decodedBB.getCompileStatus() == interpreter::DecodedBB::CompileStatus::COMPILED) {
-                    auto compiled_entry = decodedBB.getCompiledEntry();
-                    compiled_entry(&executor_, decodedBB.getRawData());
                 } else {
+                    ++dispatch_stats_.bb_cache_hits;
+                }
+                using CompileStatus = interpreter::DecodedBB::CompileStatus;
+                auto status = decodedBB.getCompileStatus();
+                // Trace ends when it loops back to its head or reaches optimized code
+                if (is_recording_ && (addr == trace_head_ || status == CompileStatus::OPTIMIZED))
+                    FinishTrace();
+                // Blocks with baseline code are interpreted while a trace is recorded, so they become part of it
+                bool run_compiled =
+                    status == CompileStatus::OPTIMIZED || (status == CompileStatus::BASELINE && !is_recording_);
+                // Baseline code has returned without executing, so the trace recording starts from here
+                if (status == CompileStatus::BASELINE && decodedBB.getHotness() == optimize_threshold_) {
+                    decodedBB.incrementHotness();
+                    if (!is_recording_) {
+                        is_recording_ = true;
+                        trace_head_ = addr;
+                    }
+                    run_compiled = false;
+                }
+                // Return which was predicted right, but whose call site wasn't linked to the return block
+                auto &return_stack = compile_queue_.getReturnStack();
+                auto *return_slot = std::exchange(return_stack.miss_slot, nullptr);
+                if (run_compiled) {
+                    if (prev_bb != nullptr)
+                        prev_bb->link(addr, &decodedBB);
+                    if (return_slot != nullptr && *return_slot == nullptr && return_stack.miss_pc == addr)
+                        decodedBB.attach(return_slot);
+                    prev_bb = RunCompiled(&decodedBB, counter);
+                    continue;
+                }
+                prev_bb = nullptr;
+                if (status == CompileStatus::RAW && !is_recording_) {
                     decodedBB.incrementHotness();
-                    if (decodedBB.getHotness() == interpreter::DecodedBB::MAX_HOTNESS) {
-                        compiler_.run(decodedBB, is_cosim_);
-                        auto compiled_entry = decodedBB.getCompiledEntry();
-                        compiled_entry(&executor_, decodedBB.getRawData());
+                    if (decodedBB.getHotness() == baseline_threshold_) {
+                        compile_queue_.compileBaseline(&decodedBB, addr, optimize_threshold_);
+                        prev_bb = RunCompiled(&decodedBB, counter);
                         continue;
                     }
+                }
+                [[unlikely]] if (is_timing_)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    executor_.RunBB(decodedBB);
+                    dispatch_stats_.interpreter_time += std::chrono::steady_clock::now() - start;
+                } else {
                     executor_.RunBB(decodedBB);
                 }
                 counter += decodedBB.size();
+                dispatch_stats_.interpreted_instrs += decodedBB.size();
+                if (is_recording_) {
+                    trace_.append(decodedBB.getRawData(), decodedBB.size(), addr);
+                    auto last_id = decodedBB.getBody()[decodedBB.size() - 1].inst_id;
+                    if (last_id == InstructionId::JALR || trace_.blocks == interpreter::Trace::MAX_BLOCKS ||
+                        trace_.instrs.size() >= interpreter::Trace::MAX_INSTRS)
+                        FinishTrace();
+                }
             } while (executor_.getPC() != 0);
 
+            dispatch_stats_.compiled_instrs = counter - dispatch_stats_.interpreted_instrs;
+            if (trace_cache_)
+                SaveTraces();
             break;
         }
         case Mode::NONE: {
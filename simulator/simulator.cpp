@@ -40,12 +40,57 @@ int Main(int argc, const char **argv)
         app.add_option("--cosimulation", is_cosim, "Pass some true value if need to get trace of instructions");
     is_cosim_arg->default_val(false);
 
+    std::string jit_cache {};
+    app.add_option("--jit-cache", jit_cache, "Directory to keep hot traces between runs of the same binary [bb mode]");
+
+    bool is_aot {};
+    app.add_flag("--aot", is_aot, "Translate all statically reachable code before running it [bb mode]");
+
+    size_t baseline_threshold = 10;
+    app.add_option("--baseline-threshold", baseline_threshold, "Runs of a block before it gets baseline JIT code")
+        ->default_val(baseline_threshold);
+    size_t optimize_threshold = 1000;
+    app.add_option("--optimize-threshold", optimize_threshold, "Runs of a block before its trace gets optimized")
+        ->default_val(optimize_threshold);
+
+    size_t code_cache_mb = 64;
+    app.add_option("--code-cache-size", code_cache_mb, "Megabytes of JIT code kept before old blocks are evicted")
+        ->default_val(code_cache_mb);
+
+    size_t bb_cache_size = 0;
+    app.add_option("--bb-cache-size", bb_cache_size, "Decoded blocks kept at once, 0 to size by ELF text [bb mode]")
+        ->default_val(bb_cache_size);
+
+    bool perf_map {};
+    app.add_flag("--perf-map", perf_map, "Write /tmp/perf-<pid>.map naming JIT code for perf [bb mode]");
+    bool gdb_jit {};
+    app.add_flag("--gdb-jit", gdb_jit, "Register JIT code through the GDB JIT interface [bb mode]");
+
+    std::string stats {};
+    app.add_option("--stats", stats, "Print JIT and dispatch statistics after the run [text or json]")
+        ->check(CLI::IsMember({"text", "json"}));
+
     CLI11_PARSE(app, argc, argv);
 
     mem::MMU *mmu = mem::MMU::CreateMMU();
     uintptr_t entry_point = mmu->StoreElfFile(input_file);
     core::Hart hart(mmu, entry_point, is_cosim);
+    hart.SetTierThresholds(baseline_threshold, optimize_threshold);
+    hart.SetCodeCacheLimit(code_cache_mb << 20);
+    if (bb_cache_size != 0)
+        hart.SetBBCacheSize(bb_cache_size);
+    hart.UseJitDebugInfo(perf_map, gdb_jit);
+    if (is_aot)
+        hart.UseStaticTranslation();
+    if (!jit_cache.empty())
+        hart.UseTraceCache(jit_cache);
+    if (!stats.empty())
+        hart.CollectStats();
     hart.RunImpl(getMode(mode), need_to_measure);
+    if (stats == "json")
+        hart.GetStats().writeJson(std::cout);
+    else if (stats == "text")
+        hart.GetStats().writeText(std::cout);
     return 0;
 }
 }  // namespace simulator
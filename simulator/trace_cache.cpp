@@ -0,0 +1,56 @@
+#include "trace_cache.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace simulator::core {
+
+TraceCache::TraceCache(const std::string &dir, uint64_t elf_hash)
+{
+    std::ostringstream name;
+    name << dir << "/" << std::hex << elf_hash << ".traces";
+    file_ = name.str();
+}
+
+void TraceCache::Load()
+{
+    std::ifstream in(file_);
+    std::string line;
+    // Missing or foreign file just means a cold start
+    if (!std::getline(in, line) || line != HEADER)
+        return;
+
+    while (std::getline(in, line)) {
+        std::istringstream pcs(line);
+        Path path;
+        Register pc;
+        while (pcs >> std::hex >> pc)
+            path.push_back(pc);
+        if (!path.empty())
+            paths_[path.front()] = std::move(path);
+    }
+}
+
+void TraceCache::Save() const
+{
+    std::ofstream out(file_, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Unable to write trace cache " << file_ << std::endl;
+        return;
+    }
+    out << HEADER << "\n";
+    for (auto &&[head, path] : paths_) {
+        for (auto pc : path)
+            out << std::hex << pc << " ";
+        out << "\n";
+    }
+}
+
+void TraceCache::Update(const Path &path)
+{
+    if (!path.empty())
+        paths_[path.front()] = path;
+}
+
+}  // namespace simulator::core
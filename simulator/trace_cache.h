@@ -0,0 +1,41 @@
+#ifndef SIMULATOR_TRACE_CACHE_H
+#define SIMULATOR_TRACE_CACHE_H
+
+#include "macros.hpp"
+#include "interpreter/gpr.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace simulator::core {
+
+// Hot paths recorded by previous runs of the same binary, so they can be compiled right at startup.
+// Compiled code embeds host addresses (chain slots, TLB, helpers), so paths are stored instead of code
+class TraceCache final {
+public:
+    // Start PCs of the blocks of a trace, the first one is the head
+    using Path = std::vector<Register>;
+
+    TraceCache(const std::string &dir, uint64_t elf_hash);
+    NO_COPY_SEMANTIC(TraceCache)
+    NO_MOVE_SEMANTIC(TraceCache)
+
+    void Load();
+    void Save() const;
+    void Update(const Path &path);
+    inline const std::map<Register, Path> &GetPaths() const
+    {
+        return paths_;
+    }
+
+private:
+    static constexpr const char *HEADER = "rvsim-traces 1";
+
+    std::string file_;
+    // Keyed by head PC
+    std::map<Register, Path> paths_;
+};
+
+}  // namespace simulator::core
+
+#endif
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "compiler/ir.hpp"
+#include "interpreter/BB.h"
+#include "interpreter/gpr.h"
+
+namespace simulator {
+
+using compiler::IrInst;
+using compiler::Optimizer;
+
+static interpreter::Trace MakeTrace(const std::vector<Instruction> &instrs)
+{
+    interpreter::Trace trace;
+    trace.append(instrs.data(), instrs.size(), 0x1000);
+    return trace;
+}
+
+TEST(IrTest, ConstantChainTest)
+{
+    // lui x5, 0x12000; addi x5, x5, 0x345; add x6, x5, x5
+    auto trace = MakeTrace({{0, 0, 0, GPR_file::X5, 0, 0x12000, 55, InstructionId::LUI},
+                            {GPR_file::X5, 0, 0, GPR_file::X5, 0, 0x345, 19, InstructionId::ADDI},
+                            {GPR_file::X5, GPR_file::X5, 0, GPR_file::X6, 0, 0, 51, InstructionId::ADD}});
+
+    auto ir = Optimizer::run(trace);
+
+    ASSERT_EQ(ir.size(), 3);
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::NOP);
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::CONST);
+    ASSERT_EQ(ir[1].value, 0x12345);
+    ASSERT_EQ(ir[2].kind, IrInst::Kind::CONST);
+    ASSERT_EQ(ir[2].value, 0x2468a);
+}
+
+TEST(IrTest, AUIPCTest)
+{
+    // addi x1, x1, 1; auipc x5, 0x2
+    auto trace = MakeTrace({{GPR_file::X1, 0, 0, GPR_file::X1, 0, 1, 19, InstructionId::ADDI},
+                            {0, 0, 0, GPR_file::X5, 0, 0x2000, 23, InstructionId::AUIPC}});
+
+    auto ir = Optimizer::run(trace);
+
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::CONST);
+    ASSERT_EQ(ir[1].value, 0x1004 + 0x2000);
+}
+
+TEST(IrTest, X0WritesTest)
+{
+    // addi x0, x1, 1; add x0, x1, x2
+    auto trace = MakeTrace({{GPR_file::X1, 0, 0, GPR_file::X0, 0, 1, 19, InstructionId::ADDI},
+                            {GPR_file::X1, GPR_file::X2, 0, GPR_file::X0, 0, 0, 51, InstructionId::ADD}});
+
+    auto ir = Optimizer::run(trace);
+
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::NOP);
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::NOP);
+}
+
+TEST(IrTest, CopyPropagationTest)
+{
+    // addi x5, x10, 0; add x6, x5, x5
+    auto trace = MakeTrace({{GPR_file::X10, 0, 0, GPR_file::X5, 0, 0, 19, InstructionId::ADDI},
+                            {GPR_file::X5, GPR_file::X5, 0, GPR_file::X6, 0, 0, 51, InstructionId::ADD}});
+
+    auto ir = Optimizer::run(trace);
+
+    // x5 is still observable after the trace, so the move stays
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::GUEST);
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::GUEST);
+    ASSERT_EQ(ir[1].instr.rs1, GPR_file::X10);
+    ASSERT_EQ(ir[1].instr.rs2, GPR_file::X10);
+}
+
+TEST(IrTest, AddressFoldingTest)
+{
+    // addi x5, x2, 16; ld x6, 8(x5); addi x5, x0, 1
+    auto trace = MakeTrace({{GPR_file::X2, 0, 0, GPR_file::X5, 0, 16, 19, InstructionId::ADDI},
+                            {GPR_file::X5, 0, 0, GPR_file::X6, 0, 8, 3, InstructionId::LD},
+                            {GPR_file::X0, 0, 0, GPR_file::X5, 0, 1, 19, InstructionId::ADDI}});
+
+    auto ir = Optimizer::run(trace);
+
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::NOP);
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::GUEST);
+    ASSERT_EQ(ir[1].instr.rs1, GPR_file::X2);
+    ASSERT_EQ(ir[1].instr.imm, 24);
+    ASSERT_EQ(ir[2].kind, IrInst::Kind::CONST);
+}
+
+TEST(IrTest, SideExitTest)
+{
+    // addi x5, x0, 1; beq x1, x2, 8; addi x5, x0, 2
+    auto trace = MakeTrace({{GPR_file::X0, 0, 0, GPR_file::X5, 0, 1, 19, InstructionId::ADDI},
+                            {GPR_file::X1, GPR_file::X2, 0, 0, 0, 8, 99, InstructionId::BEQ},
+                            {GPR_file::X0, 0, 0, GPR_file::X5, 0, 2, 19, InstructionId::ADDI}});
+
+    auto ir = Optimizer::run(trace);
+
+    // Taken branch leaves the trace with x5 == 1
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::CONST);
+    ASSERT_EQ(ir[2].kind, IrInst::Kind::CONST);
+}
+
+TEST(IrTest, BarrierTest)
+{
+    // addi x5, x0, 1; ecall; addi x6, x5, 1
+    auto trace = MakeTrace({{GPR_file::X0, 0, 0, GPR_file::X5, 0, 1, 19, InstructionId::ADDI},
+                            {0, 0, 0, 0, 0, 0, 115, InstructionId::ECALL},
+                            {GPR_file::X5, 0, 0, GPR_file::X6, 0, 1, 19, InstructionId::ADDI}});
+
+    auto ir = Optimizer::run(trace);
+
+    // The interpreter may change x5
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::CONST);
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::GUEST);
+    ASSERT_EQ(ir[2].kind, IrInst::Kind::GUEST);
+}
+
+TEST(IrTest, FloatOpTest)
+{
+    // addi x5, x0, 1; fadd.d f1, f2, f3; fsd f1, 0(x5); addi x6, x5, 1
+    auto trace = MakeTrace({{GPR_file::X0, 0, 0, GPR_file::X5, 0, 1, 19, InstructionId::ADDI},
+                            {2, 3, 0, 1, 7, 0, 83, InstructionId::FADD_D},
+                            {GPR_file::X5, 1, 0, 0, 0, 0, 39, InstructionId::FSD},
+                            {GPR_file::X5, 0, 0, GPR_file::X6, 0, 1, 19, InstructionId::ADDI}});
+
+    auto ir = Optimizer::run(trace);
+
+    // FP registers are separate, x5 stays known
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::GUEST);
+    ASSERT_EQ(ir[2].kind, IrInst::Kind::GUEST);
+    ASSERT_EQ(ir[3].kind, IrInst::Kind::CONST);
+    ASSERT_EQ(ir[3].value, 2);
+}
+
+TEST(IrTest, CallFusionTest)
+{
+    // auipc x1, 0x1; jalr x1, 0x10(x1)
+    auto trace = MakeTrace({{0, 0, 0, GPR_file::X1, 0, 0x1000, 23, InstructionId::AUIPC},
+                            {GPR_file::X1, 0, 0, GPR_file::X1, 0, 0x10, 103, InstructionId::JALR}});
+
+    auto ir = Optimizer::run(trace);
+
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::NOP);
+    ASSERT_EQ(ir[1].kind, IrInst::Kind::JUMP);
+    ASSERT_EQ(ir[1].value, 0x1000 + 0x1000 + 0x10);
+}
+
+TEST(IrTest, CompareBranchFusionTest)
+{
+    // sltu x5, x10, x11; beq x5, x0, 8; slt x6, x10, x11; bne x0, x6, 8
+    auto trace = MakeTrace({{GPR_file::X10, GPR_file::X11, 0, GPR_file::X5, 0, 0, 51, InstructionId::SLTU},
+                            {GPR_file::X5, GPR_file::X0, 0, 0, 0, 8, 99, InstructionId::BEQ},
+                            {GPR_file::X10, GPR_file::X11, 0, GPR_file::X6, 0, 0, 51, InstructionId::SLT},
+                            {GPR_file::X0, GPR_file::X6, 0, 0, 0, 8, 99, InstructionId::BNE}});
+
+    auto ir = Optimizer::run(trace);
+
+    ASSERT_EQ(ir[1].instr.inst_id, InstructionId::BGEU);
+    ASSERT_EQ(ir[1].instr.rs1, GPR_file::X10);
+    ASSERT_EQ(ir[1].instr.rs2, GPR_file::X11);
+    ASSERT_EQ(ir[3].instr.inst_id, InstructionId::BLT);
+    // Side exits still see the comparison results
+    ASSERT_EQ(ir[0].kind, IrInst::Kind::GUEST);
+    ASSERT_EQ(ir[2].kind, IrInst::Kind::GUEST);
+}
+
+}  // namespace simulator
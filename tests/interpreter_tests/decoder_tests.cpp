@@ -29,7 +29,7 @@ TEST_F(DecoderTest, BNETest)
 
     ASSERT_EQ(instr.rs1, 0x9);
     ASSERT_EQ(instr.rs2, 0x3);
-    ASSERT_EQ(instr.imm, 5124);
+    ASSERT_EQ(instr.imm, -3068);
     ASSERT_EQ(instr.inst_id, InstructionId::BNE);
 }
 
@@ -53,7 +53,7 @@ TEST_F(DecoderTest, BGETest)
 
     ASSERT_EQ(instr.rs1, 0xd);
     ASSERT_EQ(instr.rs2, 0x18);
-    ASSERT_EQ(instr.imm, 5142);
+    ASSERT_EQ(instr.imm, -3050);
     ASSERT_EQ(instr.inst_id, InstructionId::BGE);
 }
 
@@ -146,7 +146,7 @@ TEST_F(DecoderTest, SLLITest)
 
     ASSERT_EQ(instr.rs1, 0x9);
     ASSERT_EQ(instr.rd, 0x7);
-    ASSERT_EQ(instr.imm, 12 << 20);
+    ASSERT_EQ(instr.imm, 12);
     ASSERT_EQ(instr.inst_id, InstructionId::SLLI);
 }
 
@@ -182,7 +182,7 @@ TEST_F(DecoderTest, SRLITest)
 
     ASSERT_EQ(instr.rs1, 0x15);
     ASSERT_EQ(instr.rd, 0x14);
-    ASSERT_EQ(instr.imm, 45 << 20);
+    ASSERT_EQ(instr.imm, 45);
     ASSERT_EQ(instr.inst_id, InstructionId::SRLI);
 }
 
@@ -194,7 +194,7 @@ TEST_F(DecoderTest, SRAITest)
 
     ASSERT_EQ(instr.rs1, 0x15);
     ASSERT_EQ(instr.rd, 0x14);
-    ASSERT_EQ(instr.imm, 45 << 20);
+    ASSERT_EQ(instr.imm, 45);
     ASSERT_EQ(instr.inst_id, InstructionId::SRAI);
 }
 
@@ -486,4 +486,48 @@ TEST_F(DecoderTest, SDTest)
     ASSERT_EQ(instr.inst_id, InstructionId::SD);
 }
 
+TEST_F(DecoderTest, LongBBTest)
+{
+    // 100 x addi x5, x5, 1; beq x4, x2, 1520
+    interpreter::BB raw_bb;
+    for (size_t i = 0; i < 100; ++i)
+        raw_bb.add_instr(0x00128293);
+    raw_bb.add_instr(0x5e220863);
+    interpreter::BBArena arena;
+    interpreter::DecodedBB decoded_bb;
+
+    decode_.DecodeBB(raw_bb, decoded_bb, arena);
+
+    ASSERT_EQ(decoded_bb.size(), 101);
+    ASSERT_EQ(decoded_bb.getBody()[99].inst_id, InstructionId::ADDI);
+    ASSERT_EQ(decoded_bb.getBody()[100].inst_id, InstructionId::BEQ);
+    ASSERT_EQ(decoded_bb.getBody()[101].inst_id, InstructionId::BB_END_INST);
+
+    // Shorter block reuses the body
+    const auto *body = decoded_bb.getBody();
+    raw_bb.clear();
+    raw_bb.add_instr(0x5e220863);
+    decode_.DecodeBB(raw_bb, decoded_bb, arena);
+
+    ASSERT_EQ(decoded_bb.getBody(), body);
+    ASSERT_EQ(decoded_bb.size(), 1);
+    ASSERT_EQ(decoded_bb.getBody()[1].inst_id, InstructionId::BB_END_INST);
+}
+
+TEST_F(DecoderTest, SignExtensionTest)
+{
+    // lui x1, 0x80000
+    Instruction lui = decode_.DecodeInstr(0x800000b7);
+    ASSERT_EQ(lui.imm, static_cast<Immediate_t>(0xffffffff80000000));
+
+    // jal x0, -4
+    Instruction jal = decode_.DecodeInstr(0xffdff06f);
+    ASSERT_EQ(jal.imm, -4);
+
+    // csrrs x8, cycle, x0: CSR address stays unsigned
+    Instruction csrrs = decode_.DecodeInstr(0xc0002473);
+    ASSERT_EQ(csrrs.imm, 0xc00);
+    ASSERT_EQ(csrrs.inst_id, InstructionId::CSRRS);
+}
+
 }  // namespace simulator
\ No newline at end of file
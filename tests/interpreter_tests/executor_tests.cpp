@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
+#include <bit>
+#include <limits>
 #include <vector>
+#include <interpreter/decoder.h>
 #include <interpreter/executor.h>
 #include "interpreter/gpr.h"
 #include "mmu.hpp"
@@ -32,7 +35,7 @@ TEST_F(ExecutorTest, LUITest)
 TEST_F(ExecutorTest, AUIPCTest)
 {
     // auipc x3, 0x34f0
-    Instruction auipc = {0, 0, 0, GPR_file::X3, 0, 0x34f0, 23, InstructionId::AUIPC};
+    Instruction auipc = {0, 0, 0, GPR_file::X3, 0, 0x34f0000, 23, InstructionId::AUIPC};
 
     exec_.RunInstr(&auipc);
 
@@ -170,7 +173,7 @@ TEST_F(ExecutorTest, SLTITest)
 {
     std::vector<Instruction> instructions = {
         // addi x4, x0, -5
-        {GPR_file::X0, 0, 0, GPR_file::X4, 0, static_cast<Immediate_t>(-5), 19, InstructionId::ADDI},
+        {GPR_file::X0, 0, 0, GPR_file::X4, 0, -5, 19, InstructionId::ADDI},
         // slti x7, x4, 4
         {GPR_file::X4, 0, 0, GPR_file::X7, 0, 4, 19, InstructionId::SLTI}};
 
@@ -257,7 +260,7 @@ TEST_F(ExecutorTest, SLLITest)
     std::vector<Instruction> instructions = {// addi x4, x0, 0x11
                                              {GPR_file::X0, 0, 0, GPR_file::X4, 0, 0x11, 19, InstructionId::ADDI},
                                              // slli x7, x4, 0x5
-                                             {GPR_file::X4, 0, 0, GPR_file::X7, 0, 0x500000, 19, InstructionId::SLLI}};
+                                             {GPR_file::X4, 0, 0, GPR_file::X7, 0, 5, 19, InstructionId::SLLI}};
 
     for (auto &&instr : instructions)
         exec_.RunInstr(&instr);
@@ -271,10 +274,10 @@ TEST_F(ExecutorTest, SLLITest)
 
 TEST_F(ExecutorTest, SRLITest)
 {
-    std::vector<Instruction> instructions = {// addi x4, x0, 0x403ff
-                                             {GPR_file::X0, 0, 0, GPR_file::X4, 0, 0x403ff, 19, InstructionId::ADDI},
+    std::vector<Instruction> instructions = {// addi x4, x0, 0x3ff
+                                             {GPR_file::X0, 0, 0, GPR_file::X4, 0, 0x3ff, 19, InstructionId::ADDI},
                                              // srli x7, x4, 0x5
-                                             {GPR_file::X4, 0, 0, GPR_file::X7, 0, 0x500000, 19, InstructionId::SRLI}};
+                                             {GPR_file::X4, 0, 0, GPR_file::X7, 0, 5, 19, InstructionId::SRLI}};
 
     for (auto &&instr : instructions)
         exec_.RunInstr(&instr);
@@ -288,10 +291,10 @@ TEST_F(ExecutorTest, SRLITest)
 
 TEST_F(ExecutorTest, SRAITest)
 {
-    std::vector<Instruction> instructions = {// addi x4, x0, 0xff5a
-                                             {GPR_file::X0, 0, 0, GPR_file::X4, 0, 0xff5a, 19, InstructionId::ADDI},
+    std::vector<Instruction> instructions = {// addi x4, x0, -166
+                                             {GPR_file::X0, 0, 0, GPR_file::X4, 0, -166, 19, InstructionId::ADDI},
                                              // srai x7, x4, 0x5
-                                             {GPR_file::X4, 0, 0, GPR_file::X7, 0, 0x500000, 19, InstructionId::SRAI}};
+                                             {GPR_file::X4, 0, 0, GPR_file::X7, 0, 5, 19, InstructionId::SRAI}};
 
     for (auto &&instr : instructions)
         exec_.RunInstr(&instr);
@@ -369,8 +372,8 @@ TEST_F(ExecutorTest, SLLTest)
 TEST_F(ExecutorTest, SRLTest)
 {
     std::vector<Instruction> instructions = {
-        // addi x4, x0, 0x5a
-        {GPR_file::X0, 0, 0, GPR_file::X4, 0, 0x5a00, 19, InstructionId::ADDI},
+        // addi x4, x0, -1536
+        {GPR_file::X0, 0, 0, GPR_file::X4, 0, -1536, 19, InstructionId::ADDI},
         // addi x9, x0, 0x5
         {GPR_file::X0, 0, 0, GPR_file::X9, 0, 0x5, 19, InstructionId::ADDI},
         // srl x7, x4, x9
@@ -390,8 +393,8 @@ TEST_F(ExecutorTest, SRLTest)
 TEST_F(ExecutorTest, SRATest)
 {
     std::vector<Instruction> instructions = {
-        // addi x4, x0, 0x5a
-        {GPR_file::X0, 0, 0, GPR_file::X4, 0, 0x5a00, 19, InstructionId::ADDI},
+        // addi x4, x0, -1536
+        {GPR_file::X0, 0, 0, GPR_file::X4, 0, -1536, 19, InstructionId::ADDI},
         // addi x9, x0, 0x5
         {GPR_file::X0, 0, 0, GPR_file::X9, 0, 0x5, 19, InstructionId::ADDI},
         // sra x7, x4, x9
@@ -512,6 +515,107 @@ TEST_F(ExecutorTest, ORTest)
     ASSERT_EQ(gpr.read(GPR_file::PC), 0xc);
 }
 
+TEST_F(ExecutorTest, MULTest)
+{
+    std::vector<Instruction> instructions = {
+        // addi x4, x0, -3
+        {GPR_file::X0, 0, 0, GPR_file::X4, 0, -3, 19, InstructionId::ADDI},
+        // addi x9, x0, 0x7
+        {GPR_file::X0, 0, 0, GPR_file::X9, 0, 0x7, 19, InstructionId::ADDI},
+        // mul x5, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X5, 0, 0, 51, InstructionId::MUL},
+        // mulh x6, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X6, 0, 0, 51, InstructionId::MULH},
+        // mulhu x7, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X7, 0, 0, 51, InstructionId::MULHU},
+        // mulhsu x8, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X8, 0, 0, 51, InstructionId::MULHSU},
+        // mulw x10, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X10, 0, 0, 59, InstructionId::MULW}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    auto gpr = exec_.getGPRfile();
+
+    ASSERT_EQ(gpr.read(GPR_file::X5), static_cast<Register>(-21));
+    ASSERT_EQ(gpr.read(GPR_file::X6), static_cast<Register>(-1));
+    ASSERT_EQ(gpr.read(GPR_file::X7), 6);
+    ASSERT_EQ(gpr.read(GPR_file::X8), static_cast<Register>(-1));
+    ASSERT_EQ(gpr.read(GPR_file::X10), static_cast<Register>(-21));
+    ASSERT_EQ(gpr.read(GPR_file::PC), 0x1c);
+}
+
+TEST_F(ExecutorTest, DIV_REMTest)
+{
+    std::vector<Instruction> instructions = {
+        // addi x4, x0, -7
+        {GPR_file::X0, 0, 0, GPR_file::X4, 0, -7, 19, InstructionId::ADDI},
+        // addi x9, x0, 0x2
+        {GPR_file::X0, 0, 0, GPR_file::X9, 0, 0x2, 19, InstructionId::ADDI},
+        // div x5, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X5, 0, 0, 51, InstructionId::DIV},
+        // rem x6, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X6, 0, 0, 51, InstructionId::REM},
+        // divu x7, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X7, 0, 0, 51, InstructionId::DIVU},
+        // remu x8, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X8, 0, 0, 51, InstructionId::REMU},
+        // divuw x10, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X10, 0, 0, 59, InstructionId::DIVUW},
+        // remw x11, x4, x9
+        {GPR_file::X4, GPR_file::X9, 0, GPR_file::X11, 0, 0, 59, InstructionId::REMW}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    auto gpr = exec_.getGPRfile();
+
+    ASSERT_EQ(gpr.read(GPR_file::X5), static_cast<Register>(-3));
+    ASSERT_EQ(gpr.read(GPR_file::X6), static_cast<Register>(-1));
+    ASSERT_EQ(gpr.read(GPR_file::X7), 0x7ffffffffffffffc);
+    ASSERT_EQ(gpr.read(GPR_file::X8), 1);
+    ASSERT_EQ(gpr.read(GPR_file::X10), 0x7ffffffc);
+    ASSERT_EQ(gpr.read(GPR_file::X11), static_cast<Register>(-1));
+    ASSERT_EQ(gpr.read(GPR_file::PC), 0x20);
+}
+
+TEST_F(ExecutorTest, DIV_REMSpecialCasesTest)
+{
+    std::vector<Instruction> instructions = {
+        // addi x4, x0, -1
+        {GPR_file::X0, 0, 0, GPR_file::X4, 0, -1, 19, InstructionId::ADDI},
+        // addi x9, x0, 0x1
+        {GPR_file::X0, 0, 0, GPR_file::X9, 0, 0x1, 19, InstructionId::ADDI},
+        // slli x9, x9, 63
+        {GPR_file::X9, 0, 0, GPR_file::X9, 0, 63, 19, InstructionId::SLLI},
+        // div x5, x9, x0
+        {GPR_file::X9, GPR_file::X0, 0, GPR_file::X5, 0, 0, 51, InstructionId::DIV},
+        // rem x6, x9, x0
+        {GPR_file::X9, GPR_file::X0, 0, GPR_file::X6, 0, 0, 51, InstructionId::REM},
+        // div x7, x9, x4
+        {GPR_file::X9, GPR_file::X4, 0, GPR_file::X7, 0, 0, 51, InstructionId::DIV},
+        // rem x8, x9, x4
+        {GPR_file::X9, GPR_file::X4, 0, GPR_file::X8, 0, 0, 51, InstructionId::REM},
+        // divuw x10, x9, x0
+        {GPR_file::X9, GPR_file::X0, 0, GPR_file::X10, 0, 0, 59, InstructionId::DIVUW},
+        // remuw x11, x4, x0
+        {GPR_file::X4, GPR_file::X0, 0, GPR_file::X11, 0, 0, 59, InstructionId::REMUW}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    auto gpr = exec_.getGPRfile();
+
+    ASSERT_EQ(gpr.read(GPR_file::X5), static_cast<Register>(-1));
+    ASSERT_EQ(gpr.read(GPR_file::X6), 0x8000000000000000);
+    ASSERT_EQ(gpr.read(GPR_file::X7), 0x8000000000000000);
+    ASSERT_EQ(gpr.read(GPR_file::X8), 0);
+    ASSERT_EQ(gpr.read(GPR_file::X10), static_cast<Register>(-1));
+    ASSERT_EQ(gpr.read(GPR_file::X11), static_cast<Register>(-1));
+    ASSERT_EQ(gpr.read(GPR_file::PC), 0x24);
+}
+
 TEST_F(ExecutorTest, SW_LWTest)
 {
     std::vector<Instruction> instructions = {// addi x4, x0, 0x10
@@ -572,4 +676,163 @@ TEST_F(ExecutorTest, CSRTest)
     ASSERT_EQ(csr.read(CSR_file::SEPC), 6);
 }
 
+TEST_F(ExecutorTest, FENCE_ITest)
+{
+    // Code page written before fence.i is reported for invalidation
+    mmu->MarkCodePage(0);
+    std::vector<Instruction> instructions = {
+        // fence
+        {0, 0, 0, 0, 0, 0, 15, InstructionId::FENCE},
+        // fence.i
+        {0, 0, 0, 0, 0, 0, 15, InstructionId::FENCE_I}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    auto gpr = exec_.getGPRfile();
+    ASSERT_EQ(gpr.read(GPR_file::PC), 0x8);
+    ASSERT_EQ(mmu->TakeCodeWrites(), std::vector<uintptr_t> {0});
+}
+
+TEST_F(ExecutorTest, FDIV_DTest)
+{
+    std::vector<Instruction> instructions = {
+        // addi t0, zero, 1
+        {GPR_file::X0, 0, 0, GPR_file::X5, 0, 1, 19, InstructionId::ADDI},
+        // addi t1, zero, 3
+        {GPR_file::X0, 0, 0, GPR_file::X6, 0, 3, 19, InstructionId::ADDI},
+        // fcvt.d.l f1, t0
+        {GPR_file::X5, 2, 0, 1, FPR_file::DYN, 0, 83, InstructionId::FCVT_D_L},
+        // fcvt.d.l f2, t1
+        {GPR_file::X6, 2, 0, 2, FPR_file::DYN, 0, 83, InstructionId::FCVT_D_L},
+        // fdiv.d f3, f1, f2
+        {1, 2, 0, 3, FPR_file::DYN, 0, 83, InstructionId::FDIV_D},
+        // fmadd.d f4, f2, f2, f1
+        {2, 2, 1, 4, FPR_file::DYN, 0, 67, InstructionId::FMADD_D},
+        // fmv.x.d t2, f3
+        {3, 0, 0, GPR_file::X7, 0, 0, 83, InstructionId::FMV_X_D},
+        // frflags s0
+        {GPR_file::X0, 0, 0, GPR_file::X8, 0, CSR_file::FFLAGS, 115, InstructionId::CSRRS}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    auto gpr = exec_.getGPRfile();
+    auto fpr = exec_.getFPRfile();
+    ASSERT_EQ(gpr.read(GPR_file::X7), std::bit_cast<Register>(1.0 / 3.0));
+    ASSERT_EQ(fpr.readD(4), 10.0);
+    ASSERT_EQ(gpr.read(GPR_file::X8), FPR_file::NX);
+    ASSERT_EQ(gpr.read(GPR_file::PC), 0x20);
+}
+
+TEST_F(ExecutorTest, NaNBoxingTest)
+{
+    std::vector<Instruction> instructions = {
+        // addi t0, zero, 1
+        {GPR_file::X0, 0, 0, GPR_file::X5, 0, 1, 19, InstructionId::ADDI},
+        // fmv.d.x f1, t0
+        {GPR_file::X5, 0, 0, 1, 0, 0, 83, InstructionId::FMV_D_X},
+        // fadd.s f2, f1, f1
+        {1, 1, 0, 2, FPR_file::DYN, 0, 83, InstructionId::FADD_S},
+        // fmv.x.w t1, f2
+        {2, 0, 0, GPR_file::X6, 0, 0, 83, InstructionId::FMV_X_W},
+        // fmv.w.x f3, t0
+        {GPR_file::X5, 0, 0, 3, 0, 0, 83, InstructionId::FMV_W_X}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    // Improperly boxed operands read as the canonical NaN, which isn't signaling
+    auto gpr = exec_.getGPRfile();
+    auto fpr = exec_.getFPRfile();
+    ASSERT_EQ(gpr.read(GPR_file::X6), FPR_file::CANONICAL_NAN_S);
+    ASSERT_EQ(fpr.read(2), FPR_file::NAN_BOX | FPR_file::CANONICAL_NAN_S);
+    ASSERT_EQ(fpr.read(3), FPR_file::NAN_BOX | 1);
+    ASSERT_EQ(fpr.getFflags(), 0);
+}
+
+TEST_F(ExecutorTest, FCVT_W_DTest)
+{
+    std::vector<Instruction> instructions = {
+        // addi t0, zero, -7
+        {GPR_file::X0, 0, 0, GPR_file::X5, 0, -7, 19, InstructionId::ADDI},
+        // fcvt.d.l f1, t0
+        {GPR_file::X5, 2, 0, 1, FPR_file::DYN, 0, 83, InstructionId::FCVT_D_L},
+        // fdiv.d f2, f1, f0
+        {1, 0, 0, 2, FPR_file::DYN, 0, 83, InstructionId::FDIV_D},
+        // fcvt.w.d t1, f2, rtz
+        {2, 0, 0, GPR_file::X6, FPR_file::RTZ, 0, 83, InstructionId::FCVT_W_D},
+        // fcvt.wu.d t2, f1, rtz
+        {1, 1, 0, GPR_file::X7, FPR_file::RTZ, 0, 83, InstructionId::FCVT_WU_D},
+        // fmin.d f3, f0, f2
+        {0, 2, 0, 3, 0, 0, 83, InstructionId::FMIN_D}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    // -7 / 0 is -inf, both conversions saturate
+    auto gpr = exec_.getGPRfile();
+    auto fpr = exec_.getFPRfile();
+    ASSERT_EQ(gpr.read(GPR_file::X6), 0xffffffff80000000);
+    ASSERT_EQ(gpr.read(GPR_file::X7), 0);
+    ASSERT_EQ(fpr.readD(3), -std::numeric_limits<double>::infinity());
+    ASSERT_EQ(fpr.getFflags(), FPR_file::DZ | FPR_file::NV);
+}
+
+TEST_F(ExecutorTest, FCSRTest)
+{
+    std::vector<Instruction> instructions = {
+        // addi t0, zero, 0x21
+        {GPR_file::X0, 0, 0, GPR_file::X5, 0, 0x21, 19, InstructionId::ADDI},
+        // fscsr t1, t0
+        {GPR_file::X5, 0, 0, GPR_file::X6, 0, CSR_file::FCSR, 115, InstructionId::CSRRW},
+        // frrm t2
+        {GPR_file::X0, 0, 0, GPR_file::X7, 0, CSR_file::FRM, 115, InstructionId::CSRRS},
+        // csrrci s0, fflags, 1
+        {1, 0, 0, GPR_file::X8, 0, CSR_file::FFLAGS, 115, InstructionId::CSRRCI}};
+
+    for (auto &&instr : instructions)
+        exec_.RunInstr(&instr);
+
+    auto gpr = exec_.getGPRfile();
+    auto fpr = exec_.getFPRfile();
+    ASSERT_EQ(gpr.read(GPR_file::X6), 0);
+    ASSERT_EQ(gpr.read(GPR_file::X7), FPR_file::RTZ);
+    ASSERT_EQ(gpr.read(GPR_file::X8), FPR_file::NX);
+    ASSERT_EQ(fpr.getFflags(), 0);
+    ASSERT_EQ(gpr.read(GPR_file::PC), 0x10);
+}
+
+TEST_F(ExecutorTest, ThreadedBBTest)
+{
+    // addi x5, x0, 3; addi x6, x5, 4; add x7, x5, x6; beq x4, x2, 1520
+    interpreter::BB raw_bb;
+    for (uint32_t raw_instr : {0x00300293, 0x00428313, 0x006283b3, 0x5e220863})
+        raw_bb.add_instr(raw_instr);
+    interpreter::BBArena arena;
+    interpreter::DecodedBB decoded_bb;
+    interpreter::Decoder decoder;
+    decoder.DecodeBB(raw_bb, decoded_bb, arena);
+
+    exec_.RunBB(decoded_bb);
+
+    auto gpr = exec_.getGPRfile();
+    ASSERT_EQ(gpr.read(GPR_file::X5), 3);
+    ASSERT_EQ(gpr.read(GPR_file::X6), 7);
+    ASSERT_EQ(gpr.read(GPR_file::X7), 10);
+    ASSERT_EQ(gpr.read(GPR_file::PC), 0xc + 1520);
+}
+
+TEST(CosimTraceTest, TracedRegTest)
+{
+    // fadd.d f1, f2, f3; feq.d x5, f1, f2; sd x6, 0(x2)
+    Instruction fadd = {2, 3, 0, 1, 7, 0, 83, InstructionId::FADD_D};
+    Instruction feq = {1, 2, 0, GPR_file::X5, 2, 0, 83, InstructionId::FEQ_D};
+    Instruction sd = {GPR_file::X2, GPR_file::X6, 0, 0, 0, 0, 35, InstructionId::SD};
+
+    ASSERT_EQ(interpreter::GetTracedReg(fadd), interpreter::CosimTrace::FPR_BASE + 1);
+    ASSERT_EQ(interpreter::GetTracedReg(feq), GPR_file::X5);
+    ASSERT_EQ(interpreter::GetTracedReg(sd), GPR_file::X0);
+}
+
 }  // namespace simulator
\ No newline at end of file
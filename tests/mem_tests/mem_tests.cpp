@@ -80,6 +80,31 @@ TEST(MMUTest, MMURandomAllocationTest)
     ASSERT_TRUE(mem::MMU::Destroy(mmu));
 }
 
+TEST(MMUTest, MMUCodePageWriteTest)
+{
+    mem::MMU *mmu = mem::MMU::CreateMMU();
+    uintptr_t code_addr = 0x10000;
+    uintptr_t data_addr = 0x20000;
+    mmu->StoreFourBytesFast(code_addr, 0x13);
+    mmu->StoreFourBytesFast(data_addr, 0x13);
+    mmu->MarkCodePage(code_addr + 8);
+
+    mmu->StoreEightBytesFast(data_addr, 1);
+    ASSERT_FALSE(mmu->HasCodeWrites());
+    mmu->StoreFourBytesFast(code_addr + 4, 0x73);
+    ASSERT_TRUE(mmu->HasCodeWrites());
+    ASSERT_EQ(mmu->TakeCodeWrites(), std::vector<uintptr_t> {code_addr});
+    ASSERT_EQ(mmu->LoadFourBytesFast(code_addr + 4), 0x73);
+
+    // Page is tracked again only once code is fetched from it
+    mmu->StoreFourBytesFast(code_addr + 4, 0x13);
+    ASSERT_FALSE(mmu->HasCodeWrites());
+    mmu->MarkCodePage(code_addr);
+    mmu->FlushCodePages();
+    ASSERT_EQ(mmu->TakeCodeWrites(), std::vector<uintptr_t> {code_addr});
+    ASSERT_TRUE(mem::MMU::Destroy(mmu));
+}
+
 }  // namespace simulator
 
 int main(int argc, char *argv[])